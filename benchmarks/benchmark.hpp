@@ -0,0 +1,127 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace epstl
+{
+
+/**
+ * @brief Count the branch misses of the calling thread, in user space
+ *
+ * Use a hardware counter through perf_event_open. The counter is not
+ * available outside Linux, on some virtual machines or when
+ * /proc/sys/kernel/perf_event_paranoid forbids it: isAvailable() is then
+ * false.
+ */
+class branch_miss_counter
+{
+  public:
+    branch_miss_counter()
+    {
+#ifdef __linux__
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_file = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0,
+                                          -1, -1, 0));
+#endif
+    }
+
+    ~branch_miss_counter()
+    {
+#ifdef __linux__
+        if (m_file >= 0)
+            close(m_file);
+#endif
+    }
+
+    branch_miss_counter(const branch_miss_counter&) = delete;
+    branch_miss_counter& operator=(const branch_miss_counter&) = delete;
+
+    /**
+     * @brief Tells if the hardware counter could be opened
+     */
+    bool isAvailable() const
+    {
+        return m_file >= 0;
+    }
+
+    /**
+     * @brief Reset the count and start counting
+     */
+    void start()
+    {
+#ifdef __linux__
+        if (m_file < 0)
+            return;
+        ioctl(m_file, PERF_EVENT_IOC_RESET, 0);
+        ioctl(m_file, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    /**
+     * @brief Stop counting
+     * @return Return the number of branch misses since start()
+     */
+    uint64_t stop()
+    {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (m_file < 0)
+            return 0;
+        ioctl(m_file, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(m_file, &count, sizeof(count)) != sizeof(count))
+            count = 0;
+#endif
+        return count;
+    }
+
+  private:
+    int m_file = -1;    ///< File descriptor of the counter, -1 if unavailable
+};
+
+/**
+ * @brief Run the function the given number of times and print the time
+ *
+ * The branch misses by operation are printed too when the hardware counter
+ * is available (see branch_miss_counter).
+ *
+ * @param name Name of the benchmark
+ * @param iterations Number of operations done by the function
+ * @param function Function to measure
+ */
+template<typename function_t>
+void benchmark(const char* name, std::size_t iterations, function_t function)
+{
+    branch_miss_counter counter;
+    counter.start();
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    uint64_t misses = counter.stop();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << name << " : " << ns / iterations << " ns/op";
+    if (counter.isAvailable())
+        std::cout << ", " << double(misses) / iterations << " branch-misses/op";
+    std::cout << "\n";
+}
+
+void quadtree_benchmarks();
+void geometry_benchmarks();
+
+} // namespace epstl
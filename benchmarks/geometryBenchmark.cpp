@@ -0,0 +1,162 @@
+#include <aabb_set.hpp>
+#include <geometry_tools.hpp>
+#include <point_cloud.hpp>
+#include <polygon.hpp>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace epstl
+{
+
+void geometry_benchmarks()
+{
+    const std::size_t count = 100000;
+    const std::size_t repeats = 100;
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-500.f, 500.f);
+    std::vector<Point<3, float>> points(count);
+    point_cloud<3, float> cloud;
+    cloud.reserve(count);
+    for (auto& point : points)
+    {
+        point = {distribution(generator), distribution(generator),
+                 distribution(generator)
+                };
+        cloud.push_back(point);
+    }
+    Point<3, float> origin = {1, 2, 3};
+    std::vector<float> distances(count);
+    std::unique_ptr<bool[]> inside(new bool[count]);
+
+    volatile float sink = 0;
+    benchmark("Point<3, float> squared_distance (array of points)",
+              count * repeats, [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+        {
+            origin[0] = r;
+            for (std::size_t i = 0; i < count; i++)
+                distances[i] = squared_distance(points[i], origin);
+        }
+        sink = distances[count - 1];
+    });
+
+    benchmark("point_cloud<3, float>::squared_distances", count * repeats,
+              [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+        {
+            origin[0] = r;
+            cloud.squared_distances(origin, distances.data());
+        }
+        sink = distances[count - 1];
+    });
+
+    benchmark("point_cloud<3, float>::within_radius", count * repeats, [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+            sink = cloud.within_radius(origin, 250, inside.get());
+    });
+
+    benchmark("point_cloud<3, float>::bounding_box", count * repeats, [&]()
+    {
+        Point<3, float> low, high;
+        for (std::size_t r = 0; r < repeats; r++)
+            cloud.bounding_box(low, high);
+        sink = low[0] + high[0];
+    });
+
+    const point_cloud<3, float>::matrix_t matrix =
+    {
+        {0, -1, 0, 1},
+        {1, 0, 0, 2},
+        {0, 0, 1, 3}
+    };
+    benchmark("point_cloud<3, float>::transform", count * repeats, [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+            cloud.transform(matrix);
+        sink = cloud.coordinates(0)[0];
+    });
+
+    std::vector<AABB<2, float>> boxes(count);
+    aabb_set<2, float> box_set;
+    box_set.reserve(count);
+    std::uniform_real_distribution<float> sizes(0.f, 20.f);
+    for (auto& box : boxes)
+    {
+        box.low = {distribution(generator), distribution(generator)};
+        box.high = box.low + Point<2, float> {sizes(generator), sizes(generator)};
+        box_set.push_back(box);
+    }
+    AABB<2, float> query({-50, -50}, {50, 50});
+
+    benchmark("AABB<2, float>::intersects (array of boxes)", count * repeats,
+              [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+        {
+            query.low[0] = r;
+            std::size_t overlap_count = 0;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                inside[i] = boxes[i].intersects(query);
+                overlap_count += inside[i];
+            }
+            sink = overlap_count;
+        }
+    });
+
+    benchmark("aabb_set<2, float>::intersects", count * repeats, [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+        {
+            query.low[0] = r;
+            sink = box_set.intersects(query, inside.get());
+        }
+    });
+
+    Point<2, float> ray_origin = {-500, -400};
+    Point<2, float> ray_direction = {0.8f, 0.6f};
+    benchmark("aabb_set<2, float>::intersects_ray", count * repeats, [&]()
+    {
+        for (std::size_t r = 0; r < repeats; r++)
+            sink = box_set.intersects_ray(ray_origin, ray_direction, 2000,
+                                          distances.data());
+    });
+    // Geofence with many vertices against many points
+    const std::size_t vertices = 2000;
+    vector<Point<2, float>> fence_vertices;
+    std::uniform_real_distribution<float> radii(300.f, 500.f);
+    for (std::size_t i = 0; i < vertices; i++)
+    {
+        float angle = 6.2831853f * i / vertices;
+        float radius = radii(generator);
+        fence_vertices.push_back({radius * std::cos(angle),
+                                  radius * std::sin(angle)
+                                 });
+    }
+    Polygon<float> fence(fence_vertices);
+    std::vector<float> xs(count), ys(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        xs[i] = points[i][0];
+        ys[i] = points[i][1];
+    }
+
+    benchmark("Polygon<float>::contains (2000 vertices, edges)", count, [&]()
+    {
+        sink = fence.contains(xs.data(), ys.data(), count, inside.get());
+    });
+
+    fence.build_slabs();
+    benchmark("Polygon<float>::contains (2000 vertices, slabs)", count, [&]()
+    {
+        sink = fence.contains(xs.data(), ys.data(), count, inside.get());
+    });
+}
+
+} // namespace epstl
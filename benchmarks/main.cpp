@@ -0,0 +1,10 @@
+#include "benchmark.hpp"
+
+int main()
+{
+    if (!epstl::branch_miss_counter().isAvailable())
+        std::cout << "Branch miss counter unavailable, only the times are printed\n";
+    epstl::quadtree_benchmarks();
+    epstl::geometry_benchmarks();
+    return 0;
+}
@@ -0,0 +1,149 @@
+#include <quadtree.hpp>
+#include <quadtree_region.hpp>
+#include <memory>
+#include <random>
+#include <vector>
+#include "benchmark.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Expose the bounds of the quadtree to the benchmarks
+ */
+struct quadtree_bound : public quadtree<float, int>
+{
+    typedef quadtree<float, int>::rect_bound_t rect_bound_t;
+
+    /**
+     * @brief Child selection with a chain of comparisons, for reference
+     */
+    static uint8_t branching_index(const rect_bound_t& bound, float x, float y)
+    {
+        if (x >= bound.center.x && y >= bound.center.y)
+            return quadrant_ne;
+        if (x < bound.center.x && y >= bound.center.y)
+            return quadrant_nw;
+        if (x >= bound.center.x && y < bound.center.y)
+            return quadrant_se;
+        return quadrant_sw;
+    }
+};
+
+void quadtree_benchmarks()
+{
+    const std::size_t count = 20000;
+    const std::size_t lookups = 2000000;
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> distribution(-500.f, 500.f);
+    std::vector<std::pair<float, float>> points(count);
+    for (auto& point : points)
+        point = {distribution(generator), distribution(generator)};
+    std::vector<std::pair<float, float>> queries(lookups);
+    for (auto& query : queries)
+        query = {distribution(generator), distribution(generator)};
+
+    quadtree_bound::rect_bound_t bound;
+    bound.left = -500;
+    bound.right = 500;
+    bound.bottom = -500;
+    bound.top = 500;
+
+    volatile int sink = 0;
+    benchmark("rect_bound_t child selection (if chain)", lookups, [&]()
+    {
+        int sum = 0;
+        for (std::size_t i = 0; i < lookups; i++)
+            sum += quadtree_bound::branching_index(bound, queries[i].first,
+                                                   queries[i].second);
+        sink = sum;
+    });
+
+    benchmark("rect_bound_t::childIndex", lookups, [&]()
+    {
+        int sum = 0;
+        for (std::size_t i = 0; i < lookups; i++)
+            sum += bound.childIndex(queries[i].first, queries[i].second);
+        sink = sum;
+    });
+
+    benchmark("rect_bound_t::childrenMask", lookups, [&]()
+    {
+        int sum = 0;
+        for (std::size_t i = 0; i < lookups; i++)
+        {
+            float x = queries[i].first;
+            float y = queries[i].second;
+            sum += bound.childrenMask(x, y, x, y);
+        }
+        sink = sum;
+    });
+
+    quadtree<float, int> tree(1000, 1000);
+    for (std::size_t i = 0; i < count; i++)
+        tree.insert(points[i].first, points[i].second, i + 1);
+
+    benchmark("quadtree<float, int>::at (hit)", lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++)
+        {
+            const auto& point = points[i % count];
+            sink = sink + tree.at(point.first, point.second);
+        }
+    });
+
+    benchmark("quadtree<float, int>::at (miss)", lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++)
+            sink = sink + tree.at(queries[i].first, queries[i].second);
+    });
+
+    std::uniform_int_distribution<int> cells(-2048, 2047);
+    std::vector<std::pair<int, int>> updates(lookups);
+    for (auto& update : updates)
+        update = {cells(generator), cells(generator)};
+    quadtree_region<int> region(4096, 4096);
+    region.set_rect(-1024, -1024, 1024, 1024);
+
+    benchmark("quadtree_region<int>::set/unset (single cell)", lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++)
+        {
+            if (i & 1)
+                region.unset(updates[i].first, updates[i].second);
+            else
+                region.set(updates[i].first, updates[i].second);
+        }
+        sink = region.size();
+    });
+
+    std::vector<int> xs(lookups), ys(lookups);
+    for (std::size_t i = 0; i < lookups; i++)
+    {
+        xs[i] = updates[i].first;
+        ys[i] = updates[i].second;
+    }
+    std::unique_ptr<bool[]> inside(new bool[lookups]);
+    benchmark("quadtree_region<int>::at (by point)", lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++)
+            inside[i] = region.at(xs[i], ys[i]);
+        sink = inside[lookups - 1];
+    });
+
+    benchmark("quadtree_region<int>::contains (by point)", lookups, [&]()
+    {
+        sink = region.contains(xs.data(), ys.data(), lookups, inside.get());
+    });
+
+    const std::size_t rays = 3600;
+    std::vector<double> distances(rays);
+    benchmark("quadtree_region<int>::raycast_fan (by ray)", rays * 10, [&]()
+    {
+        for (int i = 0; i < 10; i++)
+            sink = sink + region.raycast_fan(0.5, 0.5, 0, 6.283185307 / rays, rays,
+                                             3000, distances.data());
+    });
+}
+
+} // namespace epstl
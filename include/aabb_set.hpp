@@ -0,0 +1,429 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+#include "container.hpp"
+#include "geometry_tools.hpp"
+#include "point_cloud.hpp"
+#include "simd_dispatch.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Set of axis-aligned boxes tested in batch
+ *
+ * The low and high corners are stored as two point clouds, coordinate by
+ * coordinate, so that one query is tested against consecutive boxes in the
+ * same vector register. The kernels are dispatched like the ones of
+ * point_cloud (simd_dispatch).
+ *
+ * Example :
+ * @code
+ * epstl::aabb_set<2, float> boxes;
+ *
+ * boxes.push_back({{0, 0}, {10, 10}});
+ * boxes.push_back({{20, 0}, {30, 10}});
+ * bool overlap[2];
+ * boxes.intersects({{5, 5}, {25, 6}}, overlap); // returns 2
+ * bool inside[2];
+ * boxes.contains({25, 5}, inside); // returns 1, inside[1] is true
+ * @endcode
+ */
+template<size_t k_size, typename k_type = float>
+class aabb_set : public container
+{
+  public:
+    typedef AABB<k_size, k_type> box_t;
+    typedef Point<k_size, k_type> point_t;
+
+    /**
+     * @brief Get the number of boxes
+     */
+    size_t size() const noexcept override
+    {
+        return m_low.size();
+    }
+
+    /**
+     * @brief Get the low corners of the boxes
+     */
+    const point_cloud<k_size, k_type>& lows() const noexcept
+    {
+        return m_low;
+    }
+
+    /**
+     * @brief Get the high corners of the boxes
+     */
+    const point_cloud<k_size, k_type>& highs() const noexcept
+    {
+        return m_high;
+    }
+
+    void reserve(size_t capacity);
+    size_t push_back(const box_t& box);
+    size_t pop_back();
+
+    box_t operator[](size_t i) const;
+    void set(size_t i, const box_t& box);
+    box_t bounds() const;
+
+    size_t intersects(const box_t& box, bool* overlap) const;
+    size_t contains(const point_t& point, bool* inside) const;
+    void squared_distances(const point_t& point, k_type* distances) const;
+    size_t intersects_ray(const point_t& origin, const point_t& direction,
+                          k_type max_distance, k_type* entries) const;
+
+  protected:
+    static constexpr size_t block_size = 16;    ///< Boxes processed together
+
+    static EPSTL_SIMD_KERNEL size_t intersects_kernel(
+        const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+        size_t stride, size_t count, const k_type* box_low,
+        const k_type* box_high, bool* EPSTL_RESTRICT overlap);
+    static EPSTL_SIMD_KERNEL void squared_distances_kernel(
+        const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+        size_t stride, size_t count, const k_type* point,
+        k_type* EPSTL_RESTRICT distances);
+    static EPSTL_SIMD_KERNEL size_t ray_kernel(
+        const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+        size_t stride, size_t count, const k_type* origin,
+        const k_type* inverse_direction, k_type max_distance,
+        k_type* EPSTL_RESTRICT entries);
+
+    point_cloud<k_size, k_type> m_low;  ///< Low corners
+    point_cloud<k_size, k_type> m_high; ///< High corners, same capacity
+};
+
+/**
+ * @brief Make room for the given number of boxes
+ * @param capacity Number of boxes to store without reallocation
+ */
+template<size_t k_size, typename k_type>
+void aabb_set<k_size, k_type>::reserve(size_t capacity)
+{
+    m_low.reserve(capacity);
+    m_high.reserve(capacity);
+}
+
+/**
+ * @brief Add a box at the end
+ * @param box Box to add
+ * @return Return the new number of boxes
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::push_back(const box_t& box)
+{
+    m_high.push_back(box.high);
+    return m_low.push_back(box.low);
+}
+
+/**
+ * @brief Remove the last box
+ * @return Return the new number of boxes
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::pop_back()
+{
+    m_high.pop_back();
+    return m_low.pop_back();
+}
+
+/**
+ * @brief Gather the corners of a box
+ * @param i Index of the box
+ * @return Return a copy of the box
+ */
+template<size_t k_size, typename k_type>
+typename aabb_set<k_size, k_type>::box_t aabb_set<k_size, k_type>::operator[](
+    size_t i) const
+{
+    return box_t(m_low[i], m_high[i]);
+}
+
+/**
+ * @brief Scatter the corners of a box
+ * @param i Index of the box
+ * @param box New corners
+ */
+template<size_t k_size, typename k_type>
+void aabb_set<k_size, k_type>::set(size_t i, const box_t& box)
+{
+    m_low.set(i, box.low);
+    m_high.set(i, box.high);
+}
+
+/**
+ * @brief Smallest box containing all the boxes
+ * @return Return the bounds, empty if there is no box
+ */
+template<size_t k_size, typename k_type>
+typename aabb_set<k_size, k_type>::box_t aabb_set<k_size, k_type>::bounds()
+const
+{
+    box_t bounds;
+    point_t unused;
+    m_low.bounding_box(bounds.low, unused);
+    m_high.bounding_box(unused, bounds.high);
+    return bounds;
+}
+
+/**
+ * @brief Tells which boxes share a point with the given one
+ * @param box Box to test, sides included
+ * @param[out] overlap True for each overlapping box, size() values
+ * @return Return the number of overlapping boxes
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::intersects(const box_t& box,
+        bool* overlap) const
+{
+    return simd_dispatch<intersects_kernel>(m_low.coordinates(0),
+            m_high.coordinates(0), m_low.capacity(), size(), &box.low[0],
+            &box.high[0], overlap);
+}
+
+/**
+ * @brief Tells which boxes contain the point, sides included
+ * @param point Point to test
+ * @param[out] inside True for each box containing the point, size() values
+ * @return Return the number of boxes containing the point
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::contains(const point_t& point,
+        bool* inside) const
+{
+    // A point is the box of zero size
+    return intersects(box_t(point, point), inside);
+}
+
+/**
+ * @brief Squared euclidean distance from the point to each box, 0 inside
+ * @param point Point to measure from
+ * @param[out] distances Distance of each box, size() values
+ */
+template<size_t k_size, typename k_type>
+void aabb_set<k_size, k_type>::squared_distances(const point_t& point,
+        k_type* distances) const
+{
+    simd_dispatch<squared_distances_kernel>(m_low.coordinates(0),
+            m_high.coordinates(0), m_low.capacity(), size(), &point[0],
+            distances);
+}
+
+/**
+ * @brief Cast a ray through all the boxes (slab test)
+ *
+ * Only for floating coordinates.
+ * @param origin Origin of the ray
+ * @param direction Direction of the ray, the distances are in its unit
+ * @param max_distance Length of the ray
+ * @param[out] entries Distance at which the ray enters each box, 0 if the
+ * origin is inside, infinity if the ray misses the box, size() values
+ * @return Return the number of boxes crossed by the ray
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::intersects_ray(const point_t& origin,
+        const point_t& direction, k_type max_distance, k_type* entries) const
+{
+    static_assert(std::is_floating_point<k_type>::value,
+                  "The rays need floating coordinates");
+    point_t inverse_direction;
+    for (size_t axis = 0; axis < k_size; axis++)
+        inverse_direction[axis] = 1 / direction[axis];
+    return simd_dispatch<ray_kernel>(m_low.coordinates(0),
+            m_high.coordinates(0), m_low.capacity(), size(), &origin[0],
+            &inverse_direction[0], max_distance, entries);
+}
+
+/**
+ * @brief Kernel of intersects
+ *
+ * Whole blocks of boxes, with loops of constant length so that they are
+ * vectorized, then the remaining boxes one by one.
+ * @param lows Low corners, axis by axis
+ * @param highs High corners, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of boxes
+ * @param box_low Low corner of the tested box
+ * @param box_high High corner of the tested box
+ * @param[out] overlap True for each overlapping box
+ * @return Return the number of overlapping boxes
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::intersects_kernel(
+    const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+    size_t stride, size_t count, const k_type* box_low,
+    const k_type* box_high, bool* EPSTL_RESTRICT overlap)
+{
+    size_t blocks = count / block_size * block_size;
+    size_t overlap_count = 0;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        // Integer lanes, combined with bitwise operators
+        int block[block_size];
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+            block[i] = 1;
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            const k_type* low = lows + axis * stride + first;
+            const k_type* high = highs + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+                block[i] &= (low[i] <= box_high[axis]) &
+                            (box_low[axis] <= high[i]);
+        }
+        bool* block_overlap = overlap + first;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+        {
+            block_overlap[i] = block[i];
+            overlap_count += block[i];
+        }
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        bool overlapping = true;
+        for (size_t axis = 0; axis < k_size; axis++)
+            overlapping &= (lows[axis * stride + i] <= box_high[axis]) &
+                           (box_low[axis] <= highs[axis * stride + i]);
+        overlap[i] = overlapping;
+        overlap_count += overlapping;
+    }
+    return overlap_count;
+}
+
+/**
+ * @brief Kernel of squared_distances
+ * @param lows Low corners, axis by axis
+ * @param highs High corners, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of boxes
+ * @param point Point to measure from
+ * @param[out] distances Squared distance to each box
+ */
+template<size_t k_size, typename k_type>
+void aabb_set<k_size, k_type>::squared_distances_kernel(
+    const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+    size_t stride, size_t count, const k_type* point,
+    k_type* EPSTL_RESTRICT distances)
+{
+    size_t blocks = count / block_size * block_size;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        k_type block[block_size] = {};
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            const k_type* low = lows + axis * stride + first;
+            const k_type* high = highs + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+            {
+                // Distance outside the low side or the high side, or 0
+                k_type below = low[i] - point[axis];
+                k_type above = point[axis] - high[i];
+                k_type outside = below > above ? below : above;
+                outside = outside > 0 ? outside : 0;
+                block[i] += outside * outside;
+            }
+        }
+        k_type* block_distances = distances + first;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+            block_distances[i] = block[i];
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        k_type squared = 0;
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            k_type below = lows[axis * stride + i] - point[axis];
+            k_type above = point[axis] - highs[axis * stride + i];
+            k_type outside = epstl::max(below, above, k_type(0));
+            squared += outside * outside;
+        }
+        distances[i] = squared;
+    }
+}
+
+/**
+ * @brief Kernel of intersects_ray
+ * @param lows Low corners, axis by axis
+ * @param highs High corners, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of boxes
+ * @param origin Origin of the ray
+ * @param inverse_direction Inverse of each coordinate of the direction
+ * @param max_distance Length of the ray
+ * @param[out] entries Entry distance in each box, infinity if missed
+ * @return Return the number of boxes crossed
+ */
+template<size_t k_size, typename k_type>
+size_t aabb_set<k_size, k_type>::ray_kernel(
+    const k_type* EPSTL_RESTRICT lows, const k_type* EPSTL_RESTRICT highs,
+    size_t stride, size_t count, const k_type* origin,
+    const k_type* inverse_direction, k_type max_distance,
+    k_type* EPSTL_RESTRICT entries)
+{
+    const k_type miss = std::numeric_limits<k_type>::infinity();
+    size_t blocks = count / block_size * block_size;
+    size_t hit_count = 0;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        k_type t_min[block_size];
+        k_type t_max[block_size];
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+        {
+            t_min[i] = 0;
+            t_max[i] = max_distance;
+        }
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            const k_type* low = lows + axis * stride + first;
+            const k_type* high = highs + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+            {
+                k_type t_low = (low[i] - origin[axis]) * inverse_direction[axis];
+                k_type t_high = (high[i] - origin[axis]) *
+                                inverse_direction[axis];
+                k_type t_near = t_low < t_high ? t_low : t_high;
+                k_type t_far = t_low < t_high ? t_high : t_low;
+                t_min[i] = t_near > t_min[i] ? t_near : t_min[i];
+                t_max[i] = t_far < t_max[i] ? t_far : t_max[i];
+            }
+        }
+        k_type* block_entries = entries + first;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+        {
+            bool hit = t_min[i] <= t_max[i];
+            block_entries[i] = hit ? t_min[i] : miss;
+            hit_count += hit;
+        }
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        k_type t_min = 0;
+        k_type t_max = max_distance;
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            k_type t_low = (lows[axis * stride + i] - origin[axis]) *
+                           inverse_direction[axis];
+            k_type t_high = (highs[axis * stride + i] - origin[axis]) *
+                            inverse_direction[axis];
+            t_min = epstl::max(t_min, epstl::min(t_low, t_high));
+            t_max = epstl::min(t_max, epstl::max(t_low, t_high));
+        }
+        bool hit = t_min <= t_max;
+        entries[i] = hit ? t_min : miss;
+        hit_count += hit;
+    }
+    return hit_count;
+}
+
+} // namespace epstl
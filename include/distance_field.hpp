@@ -0,0 +1,285 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+
+#include "exception.hpp"
+#include "quadtree_region.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Distance to the closest set cell of a region, updated locally
+ *
+ * The cells not farther than the maximum distance from a set cell keep their
+ * closest set cell, in a hash map: the memory grows with the area around
+ * the set cells, not with the area of the map. Setting a cell only visits the cells within the
+ * maximum distance of it. Unsetting a cell searches a new closest cell
+ * (quadtree_region::nearest_set, bounded by the maximum distance) only for
+ * the cells which used it. The cost of an update depends on the maximum
+ * distance, not on the size of the map, and a query is a lookup.
+ *
+ * The distance is measured between the cell coordinates. Only for integral
+ * keys.
+ *
+ * Example :
+ * @code
+ * // Clearance up to 5 cells on a 100 by 100 map, centered on zero
+ * epstl::distance_field<int> field(100, 100, 5);
+ *
+ * field.set(0, 0);
+ * field.distance(3, 4); // returns 5
+ * field.distance(30, 30); // returns 5, the maximum distance
+ * field.unset(0, 0);
+ * @endcode
+ */
+template<typename key_t = int>
+class distance_field
+{
+    static_assert(std::is_integral<key_t>::value,
+                  "The distance field needs integral keys");
+
+  public:
+    /**
+     * @brief Construct a field with the given center and width/height
+     * @param center_x X coordinate of the center
+     * @param center_y Y coordinate of the center
+     * @param width Width of the map
+     * @param height Height of the map
+     * @param max_distance Largest distance kept, finite
+     */
+    explicit distance_field(key_t center_x, key_t center_y, key_t width,
+                            key_t height, double max_distance);
+
+    /**
+     * @brief Construct a field centered on 0,0, with the given width/height
+     * @param width Width of the map
+     * @param height Height of the map
+     * @param max_distance Largest distance kept, finite
+     */
+    explicit distance_field(key_t width, key_t height, double max_distance) :
+        distance_field(0, 0, width, height, max_distance) {}
+
+    /**
+     * @brief Get the region of the set cells
+     */
+    const quadtree_region<key_t>& region() const noexcept
+    {
+        return m_region;
+    }
+
+    /**
+     * @brief Get the largest distance kept
+     */
+    double max_distance() const noexcept
+    {
+        return m_max_distance;
+    }
+
+    void set(key_t x, key_t y);
+    void unset(key_t x, key_t y);
+
+    double distance(key_t x, key_t y) const;
+    bool nearest(key_t x, key_t y, key_t& nearest_x, key_t& nearest_y) const;
+
+  protected:
+    bool isInside(key_t x, key_t y) const;
+    void window(key_t x, key_t y, key_t& left, key_t& bottom, key_t& right,
+                key_t& top) const;
+    uint32_t index(key_t x, key_t y) const;
+    double squared_distance(key_t x, key_t y, uint32_t cell) const;
+
+    quadtree_region<key_t> m_region;    ///< Set cells
+    double m_max_distance;              ///< Largest distance kept
+    key_t m_radius;                     ///< Cells around a change to update
+    key_t m_left;                       ///< Left of the map
+    key_t m_bottom;                     ///< Bottom of the map
+    key_t m_width;                      ///< Width of the map
+    key_t m_height;                     ///< Height of the map
+    /// Closest set cell of the cells near a set cell, by index. A standard
+    /// hash map, which epstl does not provide
+    std::unordered_map<uint32_t, uint32_t> m_nearest;
+};
+
+template<typename key_t>
+distance_field<key_t>::distance_field(key_t center_x, key_t center_y,
+                                      key_t width, key_t height,
+                                      double max_distance) :
+    m_region(center_x, center_y, width, height), m_max_distance(max_distance),
+    m_width(width), m_height(height)
+{
+    if (!(max_distance >= 0) || !std::isfinite(max_distance))
+        throw epstl::value_exception("The maximum distance needs to be finite "
+                                     "and not negative");
+    if (width <= 0 || height <= 0 ||
+            static_cast<uint64_t>(width) * height > UINT32_MAX)
+        throw epstl::value_exception("The map needs between 1 and 2^32 cells");
+    // Same bounds as the root of the region
+    m_left = center_x - width / 2.;
+    m_bottom = center_y - height / 2.;
+    // No cell of the map is farther than its largest side, and the cast of
+    // a larger distance could overflow
+    double side = static_cast<double>(epstl::max(width, height));
+    m_radius = static_cast<key_t>(epstl::min(max_distance, side));
+}
+
+/**
+ * @brief Set a cell, the cells within the maximum distance may get closer
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ */
+template<typename key_t>
+void distance_field<key_t>::set(key_t x, key_t y)
+{
+    if (!isInside(x, y) || m_region.at(x, y))
+        return;
+    m_region.set(x, y);
+    uint32_t cell = index(x, y);
+    double max_squared = m_max_distance * m_max_distance;
+    key_t left, bottom, right, top;
+    window(x, y, left, bottom, right, top);
+    for (key_t row = bottom; row <= top; row++)
+    {
+        for (key_t col = left; col <= right; col++)
+        {
+            double squared = squared_distance(col, row, cell);
+            if (squared > max_squared)
+                continue;
+            auto found = m_nearest.emplace(index(col, row), cell);
+            if (!found.second &&
+                    squared < squared_distance(col, row, found.first->second))
+                found.first->second = cell;
+        }
+    }
+}
+
+/**
+ * @brief Unset a cell, the cells which used it look for a new closest cell
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ */
+template<typename key_t>
+void distance_field<key_t>::unset(key_t x, key_t y)
+{
+    if (!isInside(x, y) || !m_region.at(x, y))
+        return;
+    m_region.unset(x, y);
+    uint32_t cell = index(x, y);
+    key_t left, bottom, right, top;
+    window(x, y, left, bottom, right, top);
+    for (key_t row = bottom; row <= top; row++)
+    {
+        for (key_t col = left; col <= right; col++)
+        {
+            auto found = m_nearest.find(index(col, row));
+            if (found == m_nearest.end() || found->second != cell)
+                continue;
+            key_t nearest_x, nearest_y;
+            if (m_region.nearest_set(col, row, nearest_x, nearest_y,
+                                     m_max_distance))
+                found->second = index(nearest_x, nearest_y);
+            else
+                m_nearest.erase(found);
+        }
+    }
+}
+
+/**
+ * @brief Distance from a cell to the closest set cell
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @return Distance, the maximum distance if there is no closer set cell
+ */
+template<typename key_t>
+double distance_field<key_t>::distance(key_t x, key_t y) const
+{
+    if (!isInside(x, y))
+        return m_max_distance;
+    auto found = m_nearest.find(index(x, y));
+    if (found == m_nearest.end())
+        return m_max_distance;
+    return std::sqrt(squared_distance(x, y, found->second));
+}
+
+/**
+ * @brief Find the closest set cell
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @param[out] nearest_x X coordinate of the closest set cell
+ * @param[out] nearest_y Y coordinate of the closest set cell
+ * @return Return true if a set cell is within the maximum distance
+ */
+template<typename key_t>
+bool distance_field<key_t>::nearest(key_t x, key_t y, key_t& nearest_x,
+                                    key_t& nearest_y) const
+{
+    if (!isInside(x, y))
+        return false;
+    auto found = m_nearest.find(index(x, y));
+    if (found == m_nearest.end())
+        return false;
+    nearest_x = m_left + static_cast<key_t>(found->second % m_width);
+    nearest_y = m_bottom + static_cast<key_t>(found->second / m_width);
+    return true;
+}
+
+/**
+ * @brief Tells if the cell is on the map
+ */
+template<typename key_t>
+bool distance_field<key_t>::isInside(key_t x, key_t y) const
+{
+    return x >= m_left && x < m_left + m_width && y >= m_bottom &&
+           y < m_bottom + m_height;
+}
+
+/**
+ * @brief Cells of the map within the radius of a cell of the map, along
+ * each axis
+ *
+ * The bounds are compared as differences, which do not overflow.
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @param[out] left Left of the window
+ * @param[out] bottom Bottom of the window
+ * @param[out] right Right of the window (included)
+ * @param[out] top Top of the window (included)
+ */
+template<typename key_t>
+void distance_field<key_t>::window(key_t x, key_t y, key_t& left,
+                                   key_t& bottom, key_t& right,
+                                   key_t& top) const
+{
+    key_t last_x = m_left + (m_width - 1);
+    key_t last_y = m_bottom + (m_height - 1);
+    left = x - m_left > m_radius ? x - m_radius : m_left;
+    bottom = y - m_bottom > m_radius ? y - m_radius : m_bottom;
+    right = last_x - x > m_radius ? x + m_radius : last_x;
+    top = last_y - y > m_radius ? y + m_radius : last_y;
+}
+
+/**
+ * @brief Index of the cell in the grid, the first row is the bottom
+ */
+template<typename key_t>
+uint32_t distance_field<key_t>::index(key_t x, key_t y) const
+{
+    return static_cast<uint32_t>(y - m_bottom) * m_width + (x - m_left);
+}
+
+/**
+ * @brief Squared distance between a cell and the cell of the given index
+ */
+template<typename key_t>
+double distance_field<key_t>::squared_distance(key_t x, key_t y,
+        uint32_t cell) const
+{
+    double dx = static_cast<double>(m_left) + cell % m_width - x;
+    double dy = static_cast<double>(m_bottom) + cell / m_width - y;
+    return dx * dx + dy * dy;
+}
+
+} // namespace epstl
@@ -1,11 +1,49 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <initializer_list>
+#include <limits>
 #include <type_traits>
 #include <_types.hpp>
+#include <math.hpp>
 
 namespace epstl
 {
+/**
+ * @brief Alignment of the coordinates of a point
+ *
+ * The coordinates are aligned on their size rounded up to a power of two, up
+ * to 16 bytes, so that the small points load in a single SSE register.
+ */
+template<typename k_type>
+constexpr size_t point_alignment(size_t k_size)
+{
+    size_t alignment = alignof(k_type);
+    while (alignment < k_size * sizeof(k_type) && alignment < 16)
+        alignment *= 2;
+    return alignment;
+}
+
+/**
+ * @brief Point or vector of k_size coordinates
+ *
+ * The arithmetic operators work coordinate by coordinate, a scalar applies
+ * to all the coordinates and is converted to the coordinate type. The
+ * operations are loops over the coordinates on aligned storage: the compiler
+ * unrolls them and packs the coordinates in SIMD registers (addps, mulpd...).
+ *
+ * Example :
+ * @code
+ * epstl::Point<3> a{1, 2, 3};
+ * epstl::Point<3> b{4, 5, 6};
+ *
+ * epstl::Point<3> c = a + 2 * b; // 9, 12, 15
+ * a.dot(b); // returns 32
+ * epstl::squared_distance(a, b); // returns 27
+ * epstl::lerp(a, b, 0.5); // 2.5, 3.5, 4.5
+ * @endcode
+ */
 #if __cplusplus >= 201702L
 template<size_t k_size, typename k_type = double, typename = typename std::enable_if_t<(k_size > 0)
          >>
@@ -16,25 +54,30 @@ template<size_t k_size, typename k_type = double, typename = typename std::enabl
 class Point
 {
   public:
-    Point() = default;
-    Point(std::initializer_list<k_type> coordinates)
+    constexpr Point() = default;
+
+    /**
+     * @brief Construct a point from its first coordinates, the others are 0
+     * @param coordinates Up to k_size coordinates
+     */
+    constexpr Point(std::initializer_list<k_type> coordinates)
     {
-        // Too many coordinates given in initializer_list
-        assert(coordinates.size() <= k_size);
+        if (coordinates.size() > k_size)
+            throw epstl::value_exception("Too many coordinates given to the point");
         size_t i = 0;
-        for (auto& c : coordinates)
+        for (const k_type& c : coordinates)
         {
             m_coordinates[i] = c;
             i++;
         }
     }
 
-    k_type& operator[](size_t i)
+    constexpr k_type& operator[](size_t i)
     {
         return m_coordinates[i];
     }
 
-    const k_type& operator[](size_t i) const
+    constexpr const k_type& operator[](size_t i) const
     {
         return m_coordinates[i];
     }
@@ -46,55 +89,617 @@ class Point
 
     /// @brief Get and modify the x coordinate (0)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 1) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 1) >>
 #endif
-    k_type & x() noexcept
+    constexpr k_type & x() noexcept
     {
         return m_coordinates[0];
     }
     /// @brief Get and modify the y coordinate (1)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 2) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 2) >>
 #endif
-    k_type & y() noexcept
+    constexpr k_type & y() noexcept
     {
         return m_coordinates[1];
     }
     /// @brief Get and modify the z coordinate (2)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 3) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 3) >>
 #endif
-    k_type & z() noexcept
+    constexpr k_type & z() noexcept
     {
         return m_coordinates[2];
     }
     /// @brief Get the x coordinate (0)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 1) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 1) >>
 #endif
-    k_type x() const noexcept
+    constexpr k_type x() const noexcept
     {
         return m_coordinates[0];
     }
     /// @brief Get the y coordinate (1)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 2) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 2) >>
 #endif
-    k_type y() const noexcept
+    constexpr k_type y() const noexcept
     {
         return m_coordinates[1];
     }
     /// @brief Get the z coordinate (2)
 #if __cplusplus >= 201702L
-    template<typename = std::enable_if_t<(k_size >= 3) >>
+    template<size_t size = k_size, typename = std::enable_if_t<(size >= 3) >>
 #endif
-    k_type z() const noexcept
+    constexpr k_type z() const noexcept
     {
         return m_coordinates[2];
     }
 
+    constexpr Point& operator+=(const Point& other) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] += other.m_coordinates[i];
+        return *this;
+    }
+
+    constexpr Point& operator-=(const Point& other) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] -= other.m_coordinates[i];
+        return *this;
+    }
+
+    constexpr Point& operator*=(const Point& other) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] *= other.m_coordinates[i];
+        return *this;
+    }
+
+    constexpr Point& operator/=(const Point& other) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] /= other.m_coordinates[i];
+        return *this;
+    }
+
+    constexpr Point& operator*=(k_type scalar) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] *= scalar;
+        return *this;
+    }
+
+    constexpr Point& operator/=(k_type scalar) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+            m_coordinates[i] /= scalar;
+        return *this;
+    }
+
+    constexpr Point operator-() const noexcept
+    {
+        Point negated;
+        for (size_t i = 0; i < k_size; i++)
+            negated.m_coordinates[i] = -m_coordinates[i];
+        return negated;
+    }
+
+    constexpr bool operator==(const Point& other) const noexcept
+    {
+        bool equal = true;
+        for (size_t i = 0; i < k_size; i++)
+            equal &= m_coordinates[i] == other.m_coordinates[i];
+        return equal;
+    }
+
+    constexpr bool operator!=(const Point& other) const noexcept
+    {
+        return !(*this == other);
+    }
+
+    /**
+     * @brief Dot product with the other point
+     */
+    constexpr k_type dot(const Point& other) const noexcept
+    {
+        k_type sum = 0;
+        for (size_t i = 0; i < k_size; i++)
+            sum += m_coordinates[i] * other.m_coordinates[i];
+        return sum;
+    }
+
+    /**
+     * @brief Squared euclidean norm, without the square root
+     */
+    constexpr k_type squared_norm() const noexcept
+    {
+        return dot(*this);
+    }
+
+    /**
+     * @brief Euclidean norm
+     */
+    k_type norm() const noexcept
+    {
+        return std::sqrt(squared_norm());
+    }
+
   private:
-    k_type m_coordinates[k_size];
+    alignas(point_alignment<k_type>(k_size)) k_type m_coordinates[k_size] {};
+};
+
+/**
+ * @brief Coordinate by coordinate sum
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator+(Point<k_size, k_type, enable>
+        a, const Point<k_size, k_type, enable>& b) noexcept
+{
+    return a += b;
+}
+
+/**
+ * @brief Coordinate by coordinate difference
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator-(Point<k_size, k_type, enable>
+        a, const Point<k_size, k_type, enable>& b) noexcept
+{
+    return a -= b;
+}
+
+/**
+ * @brief Coordinate by coordinate product
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator*(Point<k_size, k_type, enable>
+        a, const Point<k_size, k_type, enable>& b) noexcept
+{
+    return a *= b;
+}
+
+/**
+ * @brief Coordinate by coordinate quotient
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator/(Point<k_size, k_type, enable>
+        a, const Point<k_size, k_type, enable>& b) noexcept
+{
+    return a /= b;
+}
+
+/**
+ * @brief Scale all the coordinates
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator*(Point<k_size, k_type, enable>
+        a, typename std::common_type<k_type>::type scalar) noexcept
+{
+    return a *= scalar;
+}
+
+/**
+ * @brief Scale all the coordinates
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator*(typename
+        std::common_type<k_type>::type scalar,
+        Point<k_size, k_type, enable> a) noexcept
+{
+    return a *= scalar;
+}
+
+/**
+ * @brief Divide all the coordinates
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> operator/(Point<k_size, k_type, enable>
+        a, typename std::common_type<k_type>::type scalar) noexcept
+{
+    return a /= scalar;
+}
+
+/**
+ * @brief Dot product of two points
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr k_type dot(const Point<k_size, k_type, enable>& a,
+                     const Point<k_size, k_type, enable>& b) noexcept
+{
+    return a.dot(b);
+}
+
+/**
+ * @brief Squared euclidean distance, without the square root
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr k_type squared_distance(const Point<k_size, k_type, enable>& a,
+                                  const Point<k_size, k_type, enable>& b) noexcept
+{
+    k_type sum = 0;
+    for (size_t i = 0; i < k_size; i++)
+    {
+        k_type difference = a[i] - b[i];
+        sum += difference * difference;
+    }
+    return sum;
+}
+
+/**
+ * @brief Euclidean distance
+ */
+template<size_t k_size, typename k_type, typename enable>
+k_type distance(const Point<k_size, k_type, enable>& a,
+                const Point<k_size, k_type, enable>& b) noexcept
+{
+    return std::sqrt(squared_distance(a, b));
+}
+
+/**
+ * @brief Coordinate by coordinate minimum
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> min(Point<k_size, k_type, enable> a,
+        const Point<k_size, k_type, enable>& b) noexcept
+{
+    for (size_t i = 0; i < k_size; i++)
+        a[i] = b[i] < a[i] ? b[i] : a[i];
+    return a;
+}
+
+/**
+ * @brief Coordinate by coordinate maximum
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> max(Point<k_size, k_type, enable> a,
+        const Point<k_size, k_type, enable>& b) noexcept
+{
+    for (size_t i = 0; i < k_size; i++)
+        a[i] = b[i] > a[i] ? b[i] : a[i];
+    return a;
+}
+
+/**
+ * @brief Clamp each coordinate between the coordinates of the bounds
+ * @param point Point to clamp
+ * @param low Lower bound of each coordinate
+ * @param high Upper bound of each coordinate
+ * @return Return the clamped point
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> clamp(const Point<k_size, k_type,
+        enable>& point, const Point<k_size, k_type, enable>& low,
+        const Point<k_size, k_type, enable>& high) noexcept
+{
+    return min(max(point, low), high);
+}
+
+/**
+ * @brief Linear interpolation between two points
+ * @param a Point for t = 0
+ * @param b Point for t = 1
+ * @param t Interpolation factor, extrapolation outside of [0, 1]
+ * @return Return a + t * (b - a)
+ */
+template<size_t k_size, typename k_type, typename enable>
+constexpr Point<k_size, k_type, enable> lerp(const Point<k_size, k_type,
+        enable>& a, const Point<k_size, k_type, enable>& b,
+        typename std::common_type<k_type>::type t) noexcept
+{
+    return a + t * (b - a);
+}
+
+/**
+ * @brief Axis-aligned bounding box, closed on all its sides
+ *
+ * A box is empty when its low corner is above its high corner on an axis.
+ * The default box is empty, with infinite corners for floating coordinates,
+ * so that expanding it by a point gives the box of the point.
+ *
+ * Example :
+ * @code
+ * epstl::AABB<2> box({0, 0}, {10, 5});
+ *
+ * box.contains({3, 4}); // returns true
+ * box.intersects(epstl::AABB<2>({8, 4}, {12, 8})); // returns true
+ * box.squared_distance({13, 9}); // returns 25
+ * box.expand(epstl::Point<2>{-2, 1}); // box is now -2, 0 to 10, 5
+ * @endcode
+ */
+template<size_t k_size, typename k_type = double>
+struct AABB
+{
+    typedef Point<k_size, k_type> point_t;
+
+    point_t low;    ///< Lowest coordinate along each axis
+    point_t high;   ///< Highest coordinate along each axis (included)
+
+    /**
+     * @brief Construct an empty box
+     */
+    constexpr AABB() noexcept
+    {
+        typedef std::numeric_limits<k_type> limits;
+        for (size_t i = 0; i < k_size; i++)
+        {
+            low[i] = limits::has_infinity ? limits::infinity() : limits::max();
+            high[i] = limits::has_infinity ? -limits::infinity() :
+                      limits::lowest();
+        }
+    }
+
+    /**
+     * @brief Construct a box from its corners
+     * @param low Lowest coordinate along each axis
+     * @param high Highest coordinate along each axis (included)
+     */
+    constexpr AABB(const point_t& low, const point_t& high) noexcept :
+        low(low), high(high) {}
+
+    /**
+     * @brief Tells if the box contains no point
+     */
+    constexpr bool isEmpty() const noexcept
+    {
+        bool empty = false;
+        for (size_t i = 0; i < k_size; i++)
+            empty |= !(low[i] <= high[i]);
+        return empty;
+    }
+
+    /**
+     * @brief Tells if the point is inside the box or on its sides
+     */
+    constexpr bool contains(const point_t& point) const noexcept
+    {
+        // Bitwise operators: no branch for the short-circuit evaluation
+        bool inside = true;
+        for (size_t i = 0; i < k_size; i++)
+            inside &= (low[i] <= point[i]) & (point[i] <= high[i]);
+        return inside;
+    }
+
+    /**
+     * @brief Tells if the other box is inside this one, an empty box is
+     * inside any box
+     */
+    constexpr bool contains(const AABB& other) const noexcept
+    {
+        bool inside = true;
+        for (size_t i = 0; i < k_size; i++)
+            inside &= (low[i] <= other.low[i]) & (other.high[i] <= high[i]);
+        return inside | other.isEmpty();
+    }
+
+    /**
+     * @brief Tells if the boxes share a point, sides included
+     */
+    constexpr bool intersects(const AABB& other) const noexcept
+    {
+        bool overlap = true;
+        for (size_t i = 0; i < k_size; i++)
+            overlap &= (low[i] <= other.high[i]) & (other.low[i] <= high[i]);
+        return overlap;
+    }
+
+    /**
+     * @brief Grow the box to contain the point
+     * @return Return the box
+     */
+    constexpr AABB& expand(const point_t& point) noexcept
+    {
+        low = epstl::min(low, point);
+        high = epstl::max(high, point);
+        return *this;
+    }
+
+    /**
+     * @brief Grow the box to contain the other box
+     * @return Return the box
+     */
+    constexpr AABB& expand(const AABB& other) noexcept
+    {
+        low = epstl::min(low, other.low);
+        high = epstl::max(high, other.high);
+        return *this;
+    }
+
+    /**
+     * @brief Move all the sides of the box outwards
+     * @param margin Distance added on each side, shrinks if negative
+     * @return Return the box
+     */
+    constexpr AABB& expand(k_type margin) noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+        {
+            low[i] -= margin;
+            high[i] += margin;
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Center of the box
+     */
+    constexpr point_t center() const noexcept
+    {
+        return (low + high) / 2;
+    }
+
+    /**
+     * @brief Size of the box along each axis
+     */
+    constexpr point_t extent() const noexcept
+    {
+        return high - low;
+    }
+
+    /**
+     * @brief Squared euclidean distance from the point to the box, 0 inside
+     */
+    constexpr k_type squared_distance(const point_t& point) const noexcept
+    {
+        return epstl::squared_distance(point, clamp(point, low, high));
+    }
+
+    /**
+     * @brief Euclidean distance from the point to the box, 0 inside
+     */
+    k_type distance(const point_t& point) const noexcept
+    {
+        return std::sqrt(squared_distance(point));
+    }
+
+    /**
+     * @brief Clip the interval of a ray to the box (slab test)
+     *
+     * The ray is origin + t * direction. The inverse of the direction is
+     * given so that a batch of boxes uses only multiplications; a zero
+     * coordinate of the direction gives an infinite inverse.
+     *
+     * @param origin Origin of the ray
+     * @param inverse_direction Inverse of each coordinate of the direction
+     * @param[in,out] t_min Start of the interval, clipped to the box
+     * @param[in,out] t_max End of the interval, clipped to the box
+     * @return Return true if the ray crosses the box within the interval
+     */
+    constexpr bool intersects_ray(const point_t& origin,
+                                  const point_t& inverse_direction,
+                                  k_type& t_min, k_type& t_max) const noexcept
+    {
+        for (size_t i = 0; i < k_size; i++)
+        {
+            k_type t_low = (low[i] - origin[i]) * inverse_direction[i];
+            k_type t_high = (high[i] - origin[i]) * inverse_direction[i];
+            k_type t_near = t_low < t_high ? t_low : t_high;
+            k_type t_far = t_low < t_high ? t_high : t_low;
+            t_min = t_near > t_min ? t_near : t_min;
+            t_max = t_far < t_max ? t_far : t_max;
+        }
+        return t_min <= t_max;
+    }
+
+    constexpr bool operator==(const AABB& other) const noexcept
+    {
+        return low == other.low && high == other.high;
+    }
+
+    constexpr bool operator!=(const AABB& other) const noexcept
+    {
+        return !(*this == other);
+    }
 };
 
+/**
+ * @brief Smallest box containing both boxes
+ */
+template<size_t k_size, typename k_type>
+constexpr AABB<k_size, k_type> merge(AABB<k_size, k_type> a,
+                                     const AABB<k_size, k_type>& b) noexcept
+{
+    return a.expand(b);
+}
+
+/**
+ * @brief Box of the points inside both boxes, empty if they do not overlap
+ */
+template<size_t k_size, typename k_type>
+constexpr AABB<k_size, k_type> intersection(const AABB<k_size, k_type>& a,
+        const AABB<k_size, k_type>& b) noexcept
+{
+    return AABB<k_size, k_type>(max(a.low, b.low), min(a.high, b.high));
+}
+
+/**
+ * @brief Rule deciding which points are inside a self-intersecting polygon
+ */
+enum fill_rule_t
+{
+    /// Inside if a ray from the point crosses an odd number of edges
+    fill_even_odd,
+    /// Inside if the polygon winds around the point
+    fill_non_zero
+};
+
+/**
+ * @brief Classify a batch of points against a polygon
+ *
+ * The edges are the outer loop and the points the inner one, so that the
+ * crossing test runs branchless over contiguous coordinates and can be
+ * vectorized. A point on a left or bottom edge is inside, a point on a right
+ * or top edge is outside.
+ *
+ * @param polygon Coordinates of the vertices: x0, y0, x1, y1...
+ * @param vertices Number of vertices
+ * @param xs X coordinates of the points
+ * @param ys Y coordinates of the points
+ * @param count Number of points
+ * @param[out] inside True for each point inside the polygon
+ * @param rule Fill rule of the polygon
+ * @return Number of points inside the polygon
+ */
+template<typename k_type, typename point_t>
+size_t points_in_polygon(const k_type* polygon, size_t vertices,
+                         const point_t* xs, const point_t* ys, size_t count,
+                         bool* inside, fill_rule_t rule = fill_even_odd)
+{
+    const size_t block_size = 256;
+    int winding[block_size];
+    size_t inside_count = 0;
+    for (size_t first = 0; first < count; first += block_size)
+    {
+        size_t block = std::min(block_size, count - first);
+        const point_t* block_xs = xs + first;
+        const point_t* block_ys = ys + first;
+        for (size_t k = 0; k < block; k++)
+            winding[k] = 0;
+        for (size_t i = 0, j = vertices - 1; i < vertices; j = i++)
+        {
+            double xi = polygon[2 * i];
+            double yi = polygon[2 * i + 1];
+            double xj = polygon[2 * j];
+            double yj = polygon[2 * j + 1];
+            if (yi == yj)
+                continue;
+            int direction = yi > yj ? 1 : -1;
+            for (size_t k = 0; k < block; k++)
+            {
+                double x = block_xs[k];
+                double y = block_ys[k];
+                bool crosses = ((yi > y) != (yj > y)) &
+                               (x < (xj - xi) * (y - yi) / (yj - yi) + xi);
+                winding[k] += crosses * direction;
+            }
+        }
+        for (size_t k = 0; k < block; k++)
+        {
+            inside[first + k] = rule == fill_even_odd ? winding[k] & 1 :
+                                winding[k] != 0;
+            inside_count += inside[first + k];
+        }
+    }
+    return inside_count;
+}
+
+/**
+ * @brief Tells if a point is inside a polygon
+ * @param polygon Coordinates of the vertices: x0, y0, x1, y1...
+ * @param vertices Number of vertices
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @param rule Fill rule of the polygon
+ * @return True if the point is inside
+ */
+template<typename k_type, typename point_t>
+bool point_in_polygon(const k_type* polygon, size_t vertices, point_t x,
+                      point_t y, fill_rule_t rule = fill_even_odd)
+{
+    bool inside;
+    points_in_polygon(polygon, vertices, &x, &y, 1, &inside, rule);
+    return inside;
+}
+
 } // namespace epstl
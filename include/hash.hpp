@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace epstl
+{
+
+/**
+ * @brief Mix the bits of a 64 bits value (splitmix64 finalizer)
+ *
+ * Two close values give unrelated results, which makes the output usable
+ * in commutative combinations (sum, xor).
+ *
+ * @param value Value to mix
+ * @return Mixed value
+ */
+inline uint64_t hash_mix(uint64_t value) noexcept
+{
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Combine a hash into a seed, order dependent
+ * @param seed Current hash
+ * @param value Hash to add
+ * @return Return the combined hash
+ */
+inline uint64_t hash_combine(uint64_t seed, uint64_t value) noexcept
+{
+    return hash_mix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) +
+                            (seed >> 2)));
+}
+
+/**
+ * @brief Hash the bytes of an object (FNV-1a)
+ * @param data Pointer on the first byte
+ * @param size Number of bytes
+ * @return Hash of the bytes
+ */
+inline uint64_t hash_bytes(const void* data, size_t size) noexcept
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Tells if hash_value can be used on the type
+ *
+ * The type needs a std::hash specialization, or a byte representation
+ * without padding.
+ */
+template<typename T>
+struct is_hashable : std::integral_constant < bool,
+    std::is_default_constructible<std::hash<T>>::value ||
+    std::has_unique_object_representations<T>::value > {};
+
+/**
+ * @brief Hash the given value
+ *
+ * Use std::hash when it is available for the type, else hash the bytes of
+ * the object.
+ *
+ * @param value Value to hash
+ * @return Hash of the value
+ */
+template<typename T>
+uint64_t hash_value(const T& value)
+{
+    static_assert(is_hashable<T>::value,
+                  "The type needs a std::hash specialization or a unique byte representation");
+    if constexpr (std::is_default_constructible<std::hash<T>>::value)
+        return hash_mix(std::hash<T> {}(value));
+    else
+        return hash_bytes(&value, sizeof(T));
+}
+
+} // namespace epstl
@@ -57,6 +57,42 @@ T max(T a, T b, Args... others)
     return max(a, max(b, others...));
 }
 
+/**
+ * @brief Get the min of the two elements
+ *
+ * The < operator need to be implemented
+ *
+ * @param a First element
+ * @param b Second element
+ * @return Return the min between a and b
+ */
+template <typename T>
+T min(T a, T b)
+{
+    return a < b ? a : b;
+}
+
+/**
+ * @brief Get the min of a list of elements
+ *
+ * The < operator need to be implemented
+ *
+ * @param a First element
+ * @param b Second element
+ * @param others Others elements
+ * @return Return the min all elements
+ */
+#if __cplusplus >= 201702L
+template < typename T, typename ...Args,
+           std::enable_if_t < (std::is_same_v<T, Args>&& ...), int > = 0 >
+#else
+template < typename T, typename ...Args>
+#endif
+T min(T a, T b, Args... others)
+{
+    return min(a, min(b, others...));
+}
+
 template<typename T>
 T modulo(T nb, T mod)
 {
@@ -0,0 +1,610 @@
+#pragma once
+
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include "container.hpp"
+#include "geometry_tools.hpp"
+#include "simd_dispatch.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Set of points stored coordinate by coordinate
+ *
+ * The coordinates are stored as one array by axis (structure of arrays),
+ * aligned on 64 bytes, so that the batch kernels load the same coordinate
+ * of consecutive points in one vector register. The kernels process the
+ * points by blocks of 16 and are compiled for SSE2, AVX2 and AVX-512, the
+ * widest instructions of the CPU being chosen at runtime (simd_dispatch).
+ *
+ * Example :
+ * @code
+ * epstl::point_cloud<3, float> cloud;
+ *
+ * cloud.push_back({1, 2, 3});
+ * cloud.push_back({4, 5, 6});
+ * float distances[2];
+ * cloud.squared_distances({1, 2, 3}, distances); // 0, 27
+ * cloud.centroid(); // 2.5, 3.5, 4.5
+ * @endcode
+ */
+template<size_t k_size, typename k_type = float>
+class point_cloud : public container
+{
+    static_assert(std::is_arithmetic<k_type>::value,
+                  "The coordinates need to be arithmetic");
+
+  public:
+    typedef Point<k_size, k_type> point_t;
+
+    /**
+     * @brief Affine transformation: row i gives the coordinate i from the
+     * coordinates of the point, the last column is the translation
+     */
+    typedef k_type matrix_t[k_size][k_size + 1];
+
+    point_cloud() = default;
+    explicit point_cloud(const point_cloud& copy);
+    explicit point_cloud(point_cloud&& move) noexcept;
+    ~point_cloud() override;
+
+    point_cloud& operator=(const point_cloud& copy);
+    point_cloud& operator=(point_cloud&& move) noexcept;
+
+    /**
+     * @brief Get the number of points
+     */
+    size_t size() const noexcept override
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Get the number of points stored without reallocation
+     */
+    size_t capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    /**
+     * @brief Get the coordinates of all the points along an axis
+     * @param axis Index of the coordinate
+     * @return Array of size() coordinates
+     */
+    const k_type* coordinates(size_t axis) const noexcept
+    {
+        return m_data + axis * m_capacity;
+    }
+
+    /**
+     * @brief Get and modify the coordinates of all the points along an axis
+     * @param axis Index of the coordinate
+     * @return Array of size() coordinates
+     */
+    k_type* coordinates(size_t axis) noexcept
+    {
+        return m_data + axis * m_capacity;
+    }
+
+    void reserve(size_t capacity);
+    size_t push_back(const point_t& point);
+    size_t pop_back();
+
+    point_t operator[](size_t i) const;
+    void set(size_t i, const point_t& point);
+
+    void squared_distances(const point_t& point, k_type* distances) const;
+    void distances(const point_t& point, k_type* distances) const;
+    size_t within_radius(const point_t& point, k_type radius,
+                         bool* inside) const;
+    bool bounding_box(point_t& low, point_t& high) const;
+    point_t centroid() const;
+    void transform(const matrix_t& matrix);
+
+  protected:
+    static constexpr size_t block_size = 16;    ///< Points processed together
+    static constexpr size_t alignment = 64;     ///< Alignment in bytes
+
+    static EPSTL_SIMD_KERNEL void squared_distances_kernel(
+        const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+        const k_type* point, k_type* EPSTL_RESTRICT distances);
+    static EPSTL_SIMD_KERNEL size_t within_radius_kernel(
+        const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+        const k_type* point, k_type squared_radius,
+        bool* EPSTL_RESTRICT inside);
+    static EPSTL_SIMD_KERNEL void bounding_box_kernel(
+        const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+        k_type* EPSTL_RESTRICT low, k_type* EPSTL_RESTRICT high);
+    static EPSTL_SIMD_KERNEL void sum_kernel(const k_type* EPSTL_RESTRICT data,
+            size_t stride, size_t count, double* EPSTL_RESTRICT sums);
+    static EPSTL_SIMD_KERNEL void transform_kernel(k_type* EPSTL_RESTRICT data,
+            size_t stride, size_t count, const k_type* EPSTL_RESTRICT matrix);
+
+    static k_type* allocate(size_t capacity);
+    static void deallocate(k_type* data);
+
+    k_type* m_data = nullptr;   ///< Coordinates, axis by axis
+    size_t m_size = 0;          ///< Number of points
+    size_t m_capacity = 0;      ///< Number of points by axis array
+};
+
+template<size_t k_size, typename k_type>
+point_cloud<k_size, k_type>::point_cloud(const point_cloud& copy)
+{
+    *this = copy;
+}
+
+template<size_t k_size, typename k_type>
+point_cloud<k_size, k_type>::point_cloud(point_cloud&& move) noexcept
+{
+    *this = std::move(move);
+}
+
+template<size_t k_size, typename k_type>
+point_cloud<k_size, k_type>::~point_cloud()
+{
+    deallocate(m_data);
+}
+
+template<size_t k_size, typename k_type>
+point_cloud<k_size, k_type>& point_cloud<k_size, k_type>::operator=(
+    const point_cloud& copy)
+{
+    if (&copy == this)
+        return *this;
+    m_size = 0;
+    if (copy.m_size == 0)
+        return *this;
+    reserve(copy.m_size);
+    for (size_t axis = 0; axis < k_size; axis++)
+        std::memcpy(coordinates(axis), copy.coordinates(axis),
+                    copy.m_size * sizeof(k_type));
+    m_size = copy.m_size;
+    return *this;
+}
+
+template<size_t k_size, typename k_type>
+point_cloud<k_size, k_type>& point_cloud<k_size, k_type>::operator=(
+    point_cloud&& move) noexcept
+{
+    if (&move == this)
+        return *this;
+    deallocate(m_data);
+    m_data = move.m_data;
+    m_size = move.m_size;
+    m_capacity = move.m_capacity;
+    move.m_data = nullptr;
+    move.m_size = 0;
+    move.m_capacity = 0;
+    return *this;
+}
+
+/**
+ * @brief Make room for the given number of points
+ * @param capacity Number of points to store without reallocation
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::reserve(size_t capacity)
+{
+    if (capacity <= m_capacity)
+        return;
+    // Whole blocks, so that each axis array stays aligned
+    capacity = (capacity + block_size - 1) / block_size * block_size;
+    k_type* data = allocate(capacity);
+    // Nothing to copy from the first allocation (null m_data)
+    if (m_size > 0)
+    {
+        for (size_t axis = 0; axis < k_size; axis++)
+            std::memcpy(data + axis * capacity, coordinates(axis),
+                        m_size * sizeof(k_type));
+    }
+    deallocate(m_data);
+    m_data = data;
+    m_capacity = capacity;
+}
+
+/**
+ * @brief Add a point at the end
+ * @param point Point to add
+ * @return Return the new number of points
+ */
+template<size_t k_size, typename k_type>
+size_t point_cloud<k_size, k_type>::push_back(const point_t& point)
+{
+    if (m_size == m_capacity)
+        reserve(m_capacity ? 2 * m_capacity : block_size);
+    m_size++;
+    set(m_size - 1, point);
+    return m_size;
+}
+
+/**
+ * @brief Remove the last point
+ * @return Return the new number of points
+ */
+template<size_t k_size, typename k_type>
+size_t point_cloud<k_size, k_type>::pop_back()
+{
+    if (m_size > 0)
+        m_size--;
+    return m_size;
+}
+
+/**
+ * @brief Gather the coordinates of a point
+ * @param i Index of the point
+ * @return Return a copy of the point
+ */
+template<size_t k_size, typename k_type>
+typename point_cloud<k_size, k_type>::point_t
+point_cloud<k_size, k_type>::operator[](size_t i) const
+{
+    point_t point;
+    for (size_t axis = 0; axis < k_size; axis++)
+        point[axis] = coordinates(axis)[i];
+    return point;
+}
+
+/**
+ * @brief Scatter the coordinates of a point
+ * @param i Index of the point
+ * @param point New coordinates
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::set(size_t i, const point_t& point)
+{
+    for (size_t axis = 0; axis < k_size; axis++)
+        coordinates(axis)[i] = point[axis];
+}
+
+/**
+ * @brief Squared euclidean distance from each point to the given one
+ * @param point Point to measure from
+ * @param[out] distances Distance of each point, size() values
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::squared_distances(const point_t& point,
+        k_type* distances) const
+{
+    simd_dispatch<squared_distances_kernel>(static_cast<const k_type*>
+            (m_data), m_capacity, m_size, &point[0], distances);
+}
+
+/**
+ * @brief Euclidean distance from each point to the given one
+ * @param point Point to measure from
+ * @param[out] distances Distance of each point, size() values
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::distances(const point_t& point,
+        k_type* distances) const
+{
+    squared_distances(point, distances);
+    for (size_t i = 0; i < m_size; i++)
+        distances[i] = std::sqrt(distances[i]);
+}
+
+/**
+ * @brief Tells which points are within the radius of the given one
+ * @param point Center of the ball
+ * @param radius Radius of the ball (included)
+ * @param[out] inside True for each point inside, size() values
+ * @return Return the number of points inside
+ */
+template<size_t k_size, typename k_type>
+size_t point_cloud<k_size, k_type>::within_radius(const point_t& point,
+        k_type radius, bool* inside) const
+{
+    return simd_dispatch<within_radius_kernel>(static_cast<const k_type*>
+            (m_data), m_capacity, m_size, &point[0], radius * radius, inside);
+}
+
+/**
+ * @brief Smallest box containing all the points
+ * @param[out] low Lowest coordinate along each axis
+ * @param[out] high Highest coordinate along each axis (included)
+ * @return Return false if the cloud is empty
+ */
+template<size_t k_size, typename k_type>
+bool point_cloud<k_size, k_type>::bounding_box(point_t& low,
+        point_t& high) const
+{
+    if (m_size == 0)
+        return false;
+    simd_dispatch<bounding_box_kernel>(static_cast<const k_type*>(m_data),
+                                       m_capacity, m_size, &low[0], &high[0]);
+    return true;
+}
+
+/**
+ * @brief Mean of the points, summed in double precision
+ * @return Return the centroid, the origin if the cloud is empty
+ */
+template<size_t k_size, typename k_type>
+typename point_cloud<k_size, k_type>::point_t
+point_cloud<k_size, k_type>::centroid() const
+{
+    point_t centroid;
+    if (m_size == 0)
+        return centroid;
+    double sums[k_size];
+    simd_dispatch<sum_kernel>(static_cast<const k_type*>(m_data), m_capacity,
+                              m_size, static_cast<double*>(sums));
+    for (size_t axis = 0; axis < k_size; axis++)
+        centroid[axis] = static_cast<k_type>(sums[axis] / m_size);
+    return centroid;
+}
+
+/**
+ * @brief Apply an affine transformation to all the points
+ * @param matrix Rows of the transformation, the last column is the
+ * translation
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::transform(const matrix_t& matrix)
+{
+    simd_dispatch<transform_kernel>(m_data, m_capacity, m_size,
+                                    &matrix[0][0]);
+}
+
+/**
+ * @brief Kernel of squared_distances
+ *
+ * Whole blocks of points, with loops of constant length so that they are
+ * vectorized, then the remaining points one by one.
+ * @param data Coordinates, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of points
+ * @param point Point to measure from
+ * @param[out] distances Squared distance of each point
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::squared_distances_kernel(
+    const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+    const k_type* point, k_type* EPSTL_RESTRICT distances)
+{
+    size_t blocks = count / block_size * block_size;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        k_type block[block_size] = {};
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            const k_type* coordinates = data + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+            {
+                k_type difference = coordinates[i] - point[axis];
+                block[i] += difference * difference;
+            }
+        }
+        k_type* block_distances = distances + first;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+            block_distances[i] = block[i];
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        k_type squared = 0;
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            k_type difference = data[axis * stride + i] - point[axis];
+            squared += difference * difference;
+        }
+        distances[i] = squared;
+    }
+}
+
+/**
+ * @brief Kernel of within_radius
+ * @param data Coordinates, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of points
+ * @param point Center of the ball
+ * @param squared_radius Squared radius of the ball
+ * @param[out] inside True for each point inside
+ * @return Return the number of points inside
+ */
+template<size_t k_size, typename k_type>
+size_t point_cloud<k_size, k_type>::within_radius_kernel(
+    const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+    const k_type* point, k_type squared_radius, bool* EPSTL_RESTRICT inside)
+{
+    size_t blocks = count / block_size * block_size;
+    size_t inside_count = 0;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        k_type block[block_size] = {};
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            const k_type* coordinates = data + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+            {
+                k_type difference = coordinates[i] - point[axis];
+                block[i] += difference * difference;
+            }
+        }
+        bool* block_inside = inside + first;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+        {
+            block_inside[i] = block[i] <= squared_radius;
+            inside_count += block_inside[i];
+        }
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        k_type squared = 0;
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            k_type difference = data[axis * stride + i] - point[axis];
+            squared += difference * difference;
+        }
+        inside[i] = squared <= squared_radius;
+        inside_count += inside[i];
+    }
+    return inside_count;
+}
+
+/**
+ * @brief Kernel of bounding_box
+ *
+ * Each lane of a block keeps its own bounds, merged at the end.
+ * @param data Coordinates, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of points, at least one
+ * @param[out] low Lowest coordinate along each axis
+ * @param[out] high Highest coordinate along each axis
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::bounding_box_kernel(
+    const k_type* EPSTL_RESTRICT data, size_t stride, size_t count,
+    k_type* EPSTL_RESTRICT low, k_type* EPSTL_RESTRICT high)
+{
+    size_t blocks = count / block_size * block_size;
+    for (size_t axis = 0; axis < k_size; axis++)
+    {
+        const k_type* coordinates = data + axis * stride;
+        k_type lanes_low[block_size];
+        k_type lanes_high[block_size];
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+            lanes_low[i] = lanes_high[i] = coordinates[0];
+        for (size_t first = 0; first < blocks; first += block_size)
+        {
+            const k_type* block = coordinates + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+            {
+                k_type value = block[i];
+                lanes_low[i] = value < lanes_low[i] ? value : lanes_low[i];
+                lanes_high[i] = value > lanes_high[i] ? value : lanes_high[i];
+            }
+        }
+        for (size_t i = blocks; i < count; i++)
+        {
+            lanes_low[0] = epstl::min(lanes_low[0], coordinates[i]);
+            lanes_high[0] = epstl::max(lanes_high[0], coordinates[i]);
+        }
+        low[axis] = lanes_low[0];
+        high[axis] = lanes_high[0];
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 1; i < block_size; i++)
+        {
+            low[axis] = epstl::min(low[axis], lanes_low[i]);
+            high[axis] = epstl::max(high[axis], lanes_high[i]);
+        }
+    }
+}
+
+/**
+ * @brief Kernel of centroid
+ *
+ * Each lane of a block keeps its own sum, added at the end.
+ * @param data Coordinates, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of points
+ * @param[out] sums Sum of the coordinates along each axis
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::sum_kernel(const k_type* EPSTL_RESTRICT
+        data, size_t stride, size_t count, double* EPSTL_RESTRICT sums)
+{
+    size_t blocks = count / block_size * block_size;
+    for (size_t axis = 0; axis < k_size; axis++)
+    {
+        const k_type* coordinates = data + axis * stride;
+        double lanes[block_size] = {};
+        for (size_t first = 0; first < blocks; first += block_size)
+        {
+            const k_type* block = coordinates + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+                lanes[i] += block[i];
+        }
+        for (size_t i = blocks; i < count; i++)
+            lanes[0] += coordinates[i];
+        sums[axis] = 0;
+        EPSTL_SIMD_BLOCK
+        for (size_t i = 0; i < block_size; i++)
+            sums[axis] += lanes[i];
+    }
+}
+
+/**
+ * @brief Kernel of transform
+ * @param data Coordinates, axis by axis
+ * @param stride Distance between the axis arrays
+ * @param count Number of points
+ * @param matrix Rows of the transformation, k_size + 1 values by row
+ */
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::transform_kernel(k_type* EPSTL_RESTRICT data,
+        size_t stride, size_t count, const k_type* EPSTL_RESTRICT matrix)
+{
+    size_t blocks = count / block_size * block_size;
+    for (size_t first = 0; first < blocks; first += block_size)
+    {
+        k_type block[k_size][block_size];
+        for (size_t row = 0; row < k_size; row++)
+        {
+            const k_type* coefficients = matrix + row * (k_size + 1);
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+                block[row][i] = coefficients[k_size];
+            for (size_t axis = 0; axis < k_size; axis++)
+            {
+                const k_type* coordinates = data + axis * stride + first;
+                EPSTL_SIMD_BLOCK
+                for (size_t i = 0; i < block_size; i++)
+                    block[row][i] += coefficients[axis] * coordinates[i];
+            }
+        }
+        for (size_t axis = 0; axis < k_size; axis++)
+        {
+            k_type* coordinates = data + axis * stride + first;
+            EPSTL_SIMD_BLOCK
+            for (size_t i = 0; i < block_size; i++)
+                coordinates[i] = block[axis][i];
+        }
+    }
+    for (size_t i = blocks; i < count; i++)
+    {
+        k_type point[k_size];
+        for (size_t row = 0; row < k_size; row++)
+        {
+            const k_type* coefficients = matrix + row * (k_size + 1);
+            point[row] = coefficients[k_size];
+            for (size_t axis = 0; axis < k_size; axis++)
+                point[row] += coefficients[axis] * data[axis * stride + i];
+        }
+        for (size_t axis = 0; axis < k_size; axis++)
+            data[axis * stride + i] = point[axis];
+    }
+}
+
+/**
+ * @brief Allocate the aligned arrays of all the axes
+ * @param capacity Number of points by axis, multiple of block_size
+ */
+template<size_t k_size, typename k_type>
+k_type* point_cloud<k_size, k_type>::allocate(size_t capacity)
+{
+    std::size_t bytes = std::size_t(k_size) * capacity * sizeof(k_type);
+    return static_cast<k_type*>(::operator new(bytes,
+                                std::align_val_t(alignment)));
+}
+
+template<size_t k_size, typename k_type>
+void point_cloud<k_size, k_type>::deallocate(k_type* data)
+{
+    if (data)
+        ::operator delete(data, std::align_val_t(alignment));
+}
+
+} // namespace epstl
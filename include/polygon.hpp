@@ -0,0 +1,538 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "geometry_tools.hpp"
+#include "vector.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Simple or self-intersecting polygon, tested against many points
+ *
+ * The polygon keeps its bounding box and the list of its non horizontal
+ * edges, so that a containment test rejects the points outside of the box
+ * and only visits the edges once, without division.
+ *
+ * build_slabs() adds an acceleration structure for the large polygons: the
+ * plane is cut into horizontal slabs at the y coordinate of each vertex, and
+ * each slab keeps the edges crossing it sorted from left to right. A point
+ * then costs two binary searches, O(log n), instead of O(n). The slabs take
+ * O(n * edges by slab) memory, about O(n sqrt(n)) for usual shapes.
+ *
+ * Like points_in_polygon, a point on a left or bottom edge is inside, a
+ * point on a right or top edge is outside.
+ *
+ * Example :
+ * @code
+ * epstl::Polygon<double> triangle = {{0, 0}, {4, 0}, {0, 4}};
+ *
+ * triangle.area(); // returns 8
+ * triangle.isCounterClockwise(); // returns true
+ * triangle.build_slabs();
+ * triangle.contains({1, 1}); // returns true
+ * @endcode
+ */
+template<typename k_type = double>
+class Polygon
+{
+  public:
+    typedef Point<2, k_type> point_t;
+    typedef AABB<2, k_type> box_t;
+
+    /**
+     * @brief Side of the polygon, between two consecutive vertices
+     */
+    struct edge_t
+    {
+        point_t start;
+        point_t end;
+    };
+
+    Polygon() = default;
+    Polygon(std::initializer_list<point_t> vertices);
+    explicit Polygon(const vector<point_t>& vertices);
+    template<typename coordinate_t>
+    explicit Polygon(const coordinate_t* coordinates, size_t vertices);
+
+    /**
+     * @brief Get the number of vertices, which is also the number of edges
+     */
+    size_t size() const noexcept
+    {
+        return m_vertices.size();
+    }
+
+    /**
+     * @brief Get a vertex
+     */
+    const point_t& operator[](size_t i) const
+    {
+        return m_vertices[i];
+    }
+
+    /**
+     * @brief Get the edge from the vertex i to the next one
+     */
+    edge_t edge(size_t i) const
+    {
+        return {m_vertices[i], m_vertices[(i + 1) % m_vertices.size()]};
+    }
+
+    /**
+     * @brief Get the smallest box containing the polygon
+     */
+    const box_t& bounding_box() const noexcept
+    {
+        return m_bounding_box;
+    }
+
+    /**
+     * @brief Tells if build_slabs() was called since the last change
+     */
+    bool hasSlabs() const noexcept
+    {
+        return !m_slab_y.empty();
+    }
+
+    double signed_area() const;
+    double area() const;
+    point_t centroid() const;
+    bool isCounterClockwise() const;
+    void reverse();
+
+    void build_slabs();
+
+    /**
+     * @brief Tells if a point is inside the polygon
+     * @param point Point to test
+     * @param rule Fill rule of the polygon
+     * @return True if the point is inside
+     */
+    bool contains(const point_t& point, fill_rule_t rule = fill_even_odd) const
+    {
+        return contains(static_cast<double>(point.x()),
+                        static_cast<double>(point.y()), rule);
+    }
+
+    bool contains(double x, double y, fill_rule_t rule = fill_even_odd) const;
+    size_t contains(const k_type* xs, const k_type* ys, size_t count,
+                    bool* inside, fill_rule_t rule = fill_even_odd) const;
+
+  protected:
+    /**
+     * @brief Non horizontal edge, as a line x = x + (y' - y) * slope
+     */
+    struct crossing_t
+    {
+        double x;           ///< X coordinate at the bottom
+        double y;           ///< Bottom of the edge (included)
+        double top;         ///< Top of the edge (excluded)
+        double slope;       ///< Change of x by unit of y
+        int direction;      ///< 1 if the edge goes up, -1 if it goes down
+
+        /// X coordinate of the edge at the height y
+        double x_at(double height) const
+        {
+            return x + (height - y) * slope;
+        }
+    };
+
+    /**
+     * @brief Edge crossing a slab, sorted from left to right
+     */
+    struct slab_edge_t
+    {
+        crossing_t crossing;    ///< Line of the edge
+        int winding;            ///< Sum of the directions up to this edge
+    };
+
+    void update();
+    bool isInside(int crossings, int winding, fill_rule_t rule) const
+    {
+        return rule == fill_even_odd ? crossings & 1 : winding != 0;
+    }
+
+    // std containers: the slabs are sorted and searched with the standard
+    // algorithms, which need random access iterators, and the arrays of large
+    // polygons need a geometric growth (epstl::vector grows by small batches)
+    std::vector<point_t> m_vertices;        ///< Vertices, in order
+    std::vector<k_type> m_coordinates;      ///< Vertices as x0, y0, x1, y1...
+    std::vector<crossing_t> m_crossings;    ///< Non horizontal edges
+    box_t m_bounding_box;                   ///< Box of the vertices
+
+    std::vector<double> m_slab_y;           ///< Limits of the slabs, sorted
+    std::vector<uint32_t> m_slab_first;     ///< First edge of each slab
+    std::vector<slab_edge_t> m_slab_edges;  ///< Edges of the slabs
+    std::vector<bool> m_slab_sorted;        ///< Edges do not cross in slab
+};
+
+template<typename k_type>
+Polygon<k_type>::Polygon(std::initializer_list<point_t> vertices) :
+    m_vertices(vertices)
+{
+    update();
+}
+
+template<typename k_type>
+Polygon<k_type>::Polygon(const vector<point_t>& vertices)
+{
+    for (size_t i = 0; i < vertices.size(); i++)
+        m_vertices.push_back(vertices[i]);
+    update();
+}
+
+/**
+ * @brief Construct a polygon from a flat array of coordinates
+ * @param coordinates Coordinates of the vertices: x0, y0, x1, y1...
+ * @param vertices Number of vertices
+ */
+template<typename k_type>
+template<typename coordinate_t>
+Polygon<k_type>::Polygon(const coordinate_t* coordinates, size_t vertices)
+{
+    for (size_t i = 0; i < vertices; i++)
+        m_vertices.push_back({static_cast<k_type>(coordinates[2 * i]),
+                              static_cast<k_type>(coordinates[2 * i + 1])
+                             });
+    update();
+}
+
+/**
+ * @brief Area of the polygon, positive if the vertices turn counter
+ * clockwise
+ */
+template<typename k_type>
+double Polygon<k_type>::signed_area() const
+{
+    double twice_area = 0;
+    for (size_t i = 0, j = size() - 1; i < size(); j = i++)
+    {
+        double xi = m_vertices[i].x();
+        double yi = m_vertices[i].y();
+        double xj = m_vertices[j].x();
+        double yj = m_vertices[j].y();
+        twice_area += xj * yi - xi * yj;
+    }
+    return twice_area / 2;
+}
+
+/**
+ * @brief Area of the polygon, the areas turning the other way are
+ * subtracted for a self-intersecting polygon
+ */
+template<typename k_type>
+double Polygon<k_type>::area() const
+{
+    return std::abs(signed_area());
+}
+
+/**
+ * @brief Center of mass of the surface
+ * @return Return the centroid, the mean of the vertices if the area is 0
+ */
+template<typename k_type>
+typename Polygon<k_type>::point_t Polygon<k_type>::centroid() const
+{
+    if (m_vertices.empty())
+        return point_t();
+    double twice_area = 0;
+    double x = 0;
+    double y = 0;
+    for (size_t i = 0, j = size() - 1; i < size(); j = i++)
+    {
+        double xi = m_vertices[i].x();
+        double yi = m_vertices[i].y();
+        double xj = m_vertices[j].x();
+        double yj = m_vertices[j].y();
+        double cross = xj * yi - xi * yj;
+        twice_area += cross;
+        x += (xi + xj) * cross;
+        y += (yi + yj) * cross;
+    }
+    if (twice_area == 0)
+    {
+        x = y = 0;
+        for (const point_t& vertex : m_vertices)
+        {
+            x += vertex.x();
+            y += vertex.y();
+        }
+        return {static_cast<k_type>(x / size()),
+                static_cast<k_type>(y / size())
+               };
+    }
+    return {static_cast<k_type>(x / (3 * twice_area)),
+            static_cast<k_type>(y / (3 * twice_area))
+           };
+}
+
+/**
+ * @brief Tells if the vertices turn counter clockwise (positive area)
+ */
+template<typename k_type>
+bool Polygon<k_type>::isCounterClockwise() const
+{
+    return signed_area() > 0;
+}
+
+/**
+ * @brief Reverse the order of the vertices, and so the orientation
+ */
+template<typename k_type>
+void Polygon<k_type>::reverse()
+{
+    bool slabs = hasSlabs();
+    std::reverse(m_vertices.begin(), m_vertices.end());
+    update();
+    if (slabs)
+        build_slabs();
+}
+
+/**
+ * @brief Build the slabs, for the polygons with many vertices
+ *
+ * An edge is added to all the slabs between its bottom and its top. The
+ * edges of a slab are sorted by their x coordinate in the middle of the
+ * slab; if two of them cross inside the slab, the slab is marked and its
+ * edges are visited one by one.
+ */
+template<typename k_type>
+void Polygon<k_type>::build_slabs()
+{
+    m_slab_y.clear();
+    m_slab_first.clear();
+    m_slab_edges.clear();
+    m_slab_sorted.clear();
+    if (m_crossings.empty())
+        return;
+
+    for (const crossing_t& crossing : m_crossings)
+    {
+        m_slab_y.push_back(crossing.y);
+        m_slab_y.push_back(crossing.top);
+    }
+    std::sort(m_slab_y.begin(), m_slab_y.end());
+    m_slab_y.erase(std::unique(m_slab_y.begin(), m_slab_y.end()),
+                   m_slab_y.end());
+    size_t slabs = m_slab_y.size() - 1;
+
+    // Count the edges of each slab, then place them (compressed rows)
+    auto slab_range = [&](const crossing_t& crossing)
+    {
+        size_t first = std::lower_bound(m_slab_y.begin(), m_slab_y.end(),
+                                        crossing.y) - m_slab_y.begin();
+        size_t last = std::lower_bound(m_slab_y.begin(), m_slab_y.end(),
+                                       crossing.top) - m_slab_y.begin();
+        return std::make_pair(first, last);
+    };
+    m_slab_first.assign(slabs + 1, 0);
+    for (const crossing_t& crossing : m_crossings)
+    {
+        auto range = slab_range(crossing);
+        for (size_t slab = range.first; slab < range.second; slab++)
+            m_slab_first[slab + 1]++;
+    }
+    for (size_t slab = 0; slab < slabs; slab++)
+        m_slab_first[slab + 1] += m_slab_first[slab];
+    m_slab_edges.resize(m_slab_first[slabs]);
+    std::vector<uint32_t> next(m_slab_first.begin(), m_slab_first.end() - 1);
+    for (const crossing_t& crossing : m_crossings)
+    {
+        auto range = slab_range(crossing);
+        for (size_t slab = range.first; slab < range.second; slab++)
+            m_slab_edges[next[slab]++].crossing = crossing;
+    }
+
+    m_slab_sorted.assign(slabs, true);
+    for (size_t slab = 0; slab < slabs; slab++)
+    {
+        auto first = m_slab_edges.begin() + m_slab_first[slab];
+        auto last = m_slab_edges.begin() + m_slab_first[slab + 1];
+        double bottom = m_slab_y[slab];
+        double top = m_slab_y[slab + 1];
+        double middle = (bottom + top) / 2;
+        std::sort(first, last,
+                  [middle](const slab_edge_t& a, const slab_edge_t& b)
+        {
+            return a.crossing.x_at(middle) < b.crossing.x_at(middle);
+        });
+        int winding = 0;
+        for (auto it = first; it != last; ++it)
+        {
+            winding += it->crossing.direction;
+            it->winding = winding;
+            if (it == first)
+                continue;
+            const crossing_t& left = (it - 1)->crossing;
+            if (it->crossing.x_at(bottom) < left.x_at(bottom) ||
+                    it->crossing.x_at(top) < left.x_at(top))
+                m_slab_sorted[slab] = false;
+        }
+    }
+}
+
+/**
+ * @brief Tells if a point is inside the polygon
+ *
+ * The coordinates are not rounded to k_type, so that the center of a cell
+ * is tested against an integral polygon.
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @param rule Fill rule of the polygon
+ * @return True if the point is inside
+ */
+template<typename k_type>
+bool Polygon<k_type>::contains(double x, double y, fill_rule_t rule) const
+{
+    const box_t& box = m_bounding_box;
+    if (!((box.low.x() <= x) & (x <= box.high.x()) & (box.low.y() <= y) &
+            (y <= box.high.y())))
+        return false;
+    int crossings = 0;
+    int winding = 0;
+    if (!hasSlabs())
+    {
+        for (const crossing_t& crossing : m_crossings)
+        {
+            bool crosses = (crossing.y <= y) & (y < crossing.top) &
+                           (x < crossing.x_at(y));
+            crossings += crosses;
+            winding += crosses * crossing.direction;
+        }
+        return isInside(crossings, winding, rule);
+    }
+
+    auto slab_it = std::upper_bound(m_slab_y.begin(), m_slab_y.end(), y);
+    if (slab_it == m_slab_y.begin() || slab_it == m_slab_y.end())
+        return false;
+    size_t slab = slab_it - m_slab_y.begin() - 1;
+    auto first = m_slab_edges.begin() + m_slab_first[slab];
+    auto last = m_slab_edges.begin() + m_slab_first[slab + 1];
+    if (!m_slab_sorted[slab])
+    {
+        for (auto it = first; it != last; ++it)
+        {
+            bool crosses = x < it->crossing.x_at(y);
+            crossings += crosses;
+            winding += crosses * it->crossing.direction;
+        }
+        return isInside(crossings, winding, rule);
+    }
+    // The edges at the right of the point are crossed by the ray
+    auto right = std::partition_point(first, last,
+                                      [x, y](const slab_edge_t& edge)
+    {
+        return edge.crossing.x_at(y) <= x;
+    });
+    if (right == last)
+        return false;
+    crossings = static_cast<int>(last - right);
+    winding = (last - 1)->winding - (right == first ? 0 : (right - 1)->winding);
+    return isInside(crossings, winding, rule);
+}
+
+/**
+ * @brief Classify a batch of points against the polygon
+ *
+ * Without slabs, the points of the bounding box are gathered by blocks and
+ * tested with points_in_polygon; with slabs, each point is searched in its
+ * slab.
+ *
+ * @param xs X coordinates of the points
+ * @param ys Y coordinates of the points
+ * @param count Number of points
+ * @param[out] inside True for each point inside the polygon
+ * @param rule Fill rule of the polygon
+ * @return Number of points inside the polygon
+ */
+template<typename k_type>
+size_t Polygon<k_type>::contains(const k_type* xs, const k_type* ys,
+                                 size_t count, bool* inside,
+                                 fill_rule_t rule) const
+{
+    if (!hasSlabs())
+    {
+        std::fill(inside, inside + count, false);
+        if (m_vertices.empty())
+            return 0;
+        // Gather the points of the bounding box, so only they visit the edges
+        const size_t block_size = 256;
+        k_type block_xs[block_size];
+        k_type block_ys[block_size];
+        size_t indexes[block_size];
+        bool block_inside[block_size];
+        const box_t& box = m_bounding_box;
+        size_t inside_count = 0;
+        for (size_t first = 0; first < count; first += block_size)
+        {
+            size_t last = epstl::min(first + block_size, count);
+            size_t block = 0;
+            for (size_t i = first; i < last; i++)
+            {
+                block_xs[block] = xs[i];
+                block_ys[block] = ys[i];
+                indexes[block] = i;
+                block += (box.low.x() <= xs[i]) & (xs[i] <= box.high.x()) &
+                         (box.low.y() <= ys[i]) & (ys[i] <= box.high.y());
+            }
+            if (block == 0)
+                continue;
+            inside_count += points_in_polygon(m_coordinates.data(), size(),
+                                              block_xs, block_ys, block,
+                                              block_inside, rule);
+            for (size_t k = 0; k < block; k++)
+                inside[indexes[k]] = block_inside[k];
+        }
+        return inside_count;
+    }
+    size_t inside_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        inside[i] = contains(static_cast<double>(xs[i]),
+                             static_cast<double>(ys[i]), rule);
+        inside_count += inside[i];
+    }
+    return inside_count;
+}
+
+/**
+ * @brief Compute the bounding box and the edge list from the vertices
+ */
+template<typename k_type>
+void Polygon<k_type>::update()
+{
+    m_bounding_box = box_t();
+    m_coordinates.clear();
+    m_crossings.clear();
+    // The slabs are built again on demand
+    m_slab_y.clear();
+    m_slab_first.clear();
+    m_slab_edges.clear();
+    m_slab_sorted.clear();
+    for (size_t i = 0, j = size() - 1; i < size(); j = i++)
+    {
+        m_bounding_box.expand(m_vertices[i]);
+        m_coordinates.push_back(m_vertices[i].x());
+        m_coordinates.push_back(m_vertices[i].y());
+        double xi = m_vertices[i].x();
+        double yi = m_vertices[i].y();
+        double xj = m_vertices[j].x();
+        double yj = m_vertices[j].y();
+        if (yi == yj)
+            continue;
+        crossing_t crossing;
+        crossing.direction = yi > yj ? 1 : -1;
+        crossing.x = yi > yj ? xj : xi;
+        crossing.y = epstl::min(yi, yj);
+        crossing.top = epstl::max(yi, yj);
+        crossing.slope = (xi - xj) / (yi - yj);
+        m_crossings.push_back(crossing);
+    }
+}
+
+} // namespace epstl
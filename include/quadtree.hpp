@@ -1,14 +1,22 @@
 #pragma once
 
+#include <atomic>
 #include <initializer_list>
 #include <ostream>
 #include <functional>
 #include <iostream>
+#include <type_traits>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include "container.hpp"
 #include "exception.hpp"
+#include "geometry_tools.hpp"
+#include "hash.hpp"
 #include "math.hpp"
 #include "pair.hpp"
+#include "vector.hpp"
 
 namespace epstl
 {
@@ -20,14 +28,40 @@ namespace epstl
 enum behaviour_t
 {
     quadtree_no_replace = 1,        ///< Do not replace data when using insert
-    quadtree_multithread = 1 << 1   ///< Use multithread operation when possible
+    quadtree_multithread = 1 << 1,  ///< Use multithread operation when possible
+    quadtree_hash = 1 << 2          ///< Maintain a content hash on each quadrant (see epstl::is_hashable)
+};
+
+/**
+ * @enum quadrant_index_t
+ * @brief Index of the children in a quadrant
+ *
+ * Bit 0 is set for the east children, bit 1 for the north children, so the
+ * index of the child containing a point is computed without branches.
+ */
+enum quadrant_index_t
+{
+    quadrant_sw = 0,    ///< South west child
+    quadrant_se = 1,    ///< South east child
+    quadrant_nw = 2,    ///< North west child
+    quadrant_ne = 3     ///< North east child
 };
 
+/**
+ * @brief Data of the quadrants of a plain quadtree: none
+ */
+struct quadtree_no_node_data {};
+
 /**
  * @brief Point quadtree
  *
  * Create a quadtree structure with one point maximum by quadrant.
  *
+ * The division stops at a maximum depth (set_max_depth) or a minimum cell
+ * size (set_min_cell_size): the leaves at the limit keep the extra points in
+ * a small overflow bucket, so clustered points do not create long chains of
+ * quadrants.
+ *
  * The item contained in the quadtree has to have a default value. By
  * default, the default value is the default constructor of the type.
  * If this value is set by the user, it will be invisible.
@@ -53,8 +87,13 @@ enum behaviour_t
  * tree.remove_all(100); // remove 5,5
  * tree.remove(3, 3); // remove 110
  * @endcode
+ *
+ * The node_data_t type is a base of every quadrant, for the derived trees
+ * which keep their own data in the quadrants (see region_quadtree). It is
+ * empty by default, so the quadrants of a point quadtree do not grow.
  */
-template<typename key_t, typename item_t>
+template<typename key_t, typename item_t,
+         typename node_data_t = quadtree_no_node_data>
 class quadtree : public container
 {
   protected:
@@ -88,23 +127,111 @@ class quadtree : public container
          */
         bool isInside(key_t x, key_t y) const
         {
-            return x >= left && x < right && y >= bottom && y < top;
+            // Bitwise and: no branch for the short-circuit evaluation
+            return (x >= left) & (x < right) & (y >= bottom) & (y < top);
+        }
+
+        /**
+         * @brief Index of the child quadrant containing the coordinates
+         *
+         * The coordinates are supposed to be inside the bounds.
+         * @param x X coordinate of the point
+         * @param y Y coordinate of the point
+         * @return Index in quadrant_t::children (see quadrant_index_t)
+         */
+        uint8_t childIndex(key_t x, key_t y) const
+        {
+            return (x >= center.x) | ((y >= center.y) << 1);
+        }
+
+        /**
+         * @brief Tells which children overlap the closed rectangle
+         *
+         * The four children bounds are tested at once.
+         * @param rect_left Left of the rectangle
+         * @param rect_bottom Bottom of the rectangle
+         * @param rect_right Right of the rectangle (included)
+         * @param rect_top Top of the rectangle (included)
+         * @return Mask of the overlapping children, bit i for the child i
+         */
+        uint8_t childrenMask(key_t rect_left, key_t rect_bottom, key_t rect_right,
+                             key_t rect_top) const
+        {
+#ifdef __SSE2__
+            if constexpr (std::is_same<key_t, float>::value)
+            {
+                __m128 inside = _mm_and_ps(
+                                    _mm_and_ps(
+                                        _mm_cmple_ps(_mm_setr_ps(left, center.x, left, center.x),
+                                                     _mm_set1_ps(rect_right)),
+                                        _mm_cmplt_ps(_mm_set1_ps(rect_left),
+                                                     _mm_setr_ps(center.x, right, center.x, right))),
+                                    _mm_and_ps(
+                                        _mm_cmple_ps(_mm_setr_ps(bottom, bottom, center.y, center.y),
+                                                     _mm_set1_ps(rect_top)),
+                                        _mm_cmplt_ps(_mm_set1_ps(rect_bottom),
+                                                     _mm_setr_ps(center.y, center.y, top, top))));
+                return _mm_movemask_ps(inside);
+            }
+            else if constexpr (std::is_same<key_t, int32_t>::value)
+            {
+                // a <= b is computed as not(a > b)
+                __m128i inside = _mm_and_si128(
+                                     _mm_andnot_si128(
+                                         _mm_cmpgt_epi32(_mm_setr_epi32(left, center.x, left, center.x),
+                                                 _mm_set1_epi32(rect_right)),
+                                         _mm_cmpgt_epi32(_mm_setr_epi32(center.x, right, center.x, right),
+                                                 _mm_set1_epi32(rect_left))),
+                                     _mm_andnot_si128(
+                                         _mm_cmpgt_epi32(_mm_setr_epi32(bottom, bottom, center.y, center.y),
+                                                 _mm_set1_epi32(rect_top)),
+                                         _mm_cmpgt_epi32(_mm_setr_epi32(center.y, center.y, top, top),
+                                                 _mm_set1_epi32(rect_bottom))));
+                return _mm_movemask_ps(_mm_castsi128_ps(inside));
+            }
+            else
+#endif
+            {
+                uint8_t west = (left <= rect_right) & (rect_left < center.x);
+                uint8_t east = (center.x <= rect_right) & (rect_left < right);
+                uint8_t south = (bottom <= rect_top) & (rect_bottom < center.y);
+                uint8_t north = (center.y <= rect_top) & (rect_bottom < top);
+                return (west & south) | ((east & south) << 1) |
+                       ((west & north) << 2) | ((east & north) << 3);
+            }
         }
     };
 
+    /**
+     * @brief Point kept in the overflow bucket of a leaf
+     */
+    struct bucket_item_t
+    {
+        position_t position;
+        item_t data;
+    };
+
     /**
      * @brief Recursive quadrant structure for point quadtree
      */
-    struct quadrant_t
+    struct quadrant_t : public node_data_t
     {
         item_t data;
         position_t data_position;
         rect_bound_t bound;
-        quadrant_t* ne = nullptr;
-        quadrant_t* nw = nullptr;
-        quadrant_t* sw = nullptr;
-        quadrant_t* se = nullptr;
+        quadrant_t* children[4] = {}; ///< Indexed by quadrant_index_t
         quadrant_t* parent = nullptr;
+        uint64_t hash = 0; ///< Content hash, maintained with quadtree_hash
+        uint32_t level = 0; ///< Number of divisions from the root
+        vector<bucket_item_t>* overflow = nullptr; ///< Extra points of a leaf which can not be divided
+
+        /**
+         * @brief Tells if the quadrant is not divided
+         */
+        bool isLeaf() const
+        {
+            return !children[0];
+        }
     };
 
   public:
@@ -118,10 +245,11 @@ class quadtree : public container
      */
 #if __cplusplus >= 201702L
     explicit quadtree(key_t center_x, key_t center_y, key_t width, key_t height) :
-        m_width(width), m_height(height), m_center{center_x, center_y}, m_default_value{} {}
+        m_default_value{}, m_height(height), m_width(width),
+        m_center{center_x, center_y} {}
 #else
     explicit quadtree(key_t center_x, key_t center_y, key_t width, key_t height) :
-        m_width(width), m_height(height)
+        m_height(height), m_width(width)
     {
         m_center.x = center_x;
         m_center.y = center_y;
@@ -134,7 +262,7 @@ class quadtree : public container
      * @param height Height of the root
      */
     explicit quadtree(key_t width, key_t height) :
-        quadtree<key_t, item_t>(0, 0, width, height) {}
+        quadtree(0, 0, width, height) {}
 
     /**
      * @brief Construct a quadtree with the given center and width/height and the default value
@@ -174,9 +302,18 @@ class quadtree : public container
      *
      * The depth is the number of subdivision. If there is only the root, the
      * depth is 0. If the quadrant is only divided by 4 once, the depth is 1.
+     *
+     * The depth is only recomputed here after quadrants were merged, so the
+     * updates do not walk the tree. This writes the cached depth: concurrent
+     * calls need an external lock, even on a const tree.
      */
     virtual size_t depth() const noexcept final
     {
+        if (m_depth_outdated)
+        {
+            m_depth = compute_depth(m_root);
+            m_depth_outdated = false;
+        }
         return m_depth;
     }
 
@@ -188,6 +325,46 @@ class quadtree : public container
         return m_default_value;
     }
 
+    /**
+     * @brief Get the maximum number of divisions from the root
+     */
+    virtual size_t max_depth() const noexcept final
+    {
+        return m_max_depth;
+    }
+
+    /**
+     * @brief Set the maximum number of divisions from the root
+     *
+     * The leaves at this depth are not divided anymore, the extra points are
+     * kept in their overflow bucket. Only the next insertions are affected.
+     * @param max_depth Maximum depth of the quadrants
+     */
+    virtual void set_max_depth(size_t max_depth) final
+    {
+        m_max_depth = max_depth;
+    }
+
+    /**
+     * @brief Get the minimum width and height of the quadrants
+     */
+    virtual key_t min_cell_size() const noexcept final
+    {
+        return m_min_cell_size;
+    }
+
+    /**
+     * @brief Set the minimum width and height of the quadrants
+     *
+     * A leaf is not divided if its children would be smaller. Only the next
+     * insertions are affected.
+     * @param min_cell_size Minimum size of the quadrants
+     */
+    virtual void set_min_cell_size(key_t min_cell_size) final
+    {
+        m_min_cell_size = min_cell_size;
+    }
+
     virtual size_t insert(key_t x, key_t y, const item_t& item);
 
     virtual const item_t& at(key_t x, key_t y) const;
@@ -202,12 +379,49 @@ class quadtree : public container
      * set_behaviour_flag(epstl::quadtree_no_replace | epstl::quadtree_multithread)
      * @endcode
      * @param flag Combinaison of behaviour_t
+     * @throw epstl::value_exception quadtree_hash is set but the item can not
+     * be hashed (see epstl::is_hashable)
      */
     virtual void set_behaviour_flag(uint8_t flag) final
     {
+        if constexpr (!is_hashable<item_t>::value)
+        {
+            // Hashing the positions alone would hide the changes of items
+            if (flag & quadtree_hash)
+                throw epstl::value_exception("The item type can not be hashed");
+        }
+        bool start_hashing = (flag & quadtree_hash) &&
+                             !(m_behaviour_flag & quadtree_hash);
         m_behaviour_flag = flag;
+        if (start_hashing)
+            rehash();
+    }
+
+    /**
+     * @brief Get the content hash of the tree
+     *
+     * The hash only depends on the points (position and item) contained in
+     * the tree, not on the way quadrants are divided. It is only maintained
+     * with the quadtree_hash behaviour flag, 0 otherwise.
+     */
+    virtual uint64_t hash() const noexcept final
+    {
+        return m_root ? m_root->hash : 0;
+    }
+
+    /**
+     * @brief Recompute the hash of all the quadrants
+     *
+     * Needed after modifying items through the mutable at().
+     */
+    virtual void rehash() final
+    {
+        compute_hash(m_root);
     }
 
+    virtual size_t diff(const quadtree& other,
+                        vector<epstl::pair<key_t>>& keys) const;
+
     /**
      * @brief Print the quadtree in the given stream
      * @param stream Stream to print inside
@@ -232,6 +446,16 @@ class quadtree : public container
         return i1 == i2;
     }) const;
 
+    virtual size_t query_range(key_t left, key_t bottom, key_t right, key_t top,
+                               vector<epstl::pair<key_t>>& keys,
+                               const std::atomic<bool>* cancel = nullptr) const;
+    size_t query_range(const AABB<2, key_t>& box,
+                       vector<epstl::pair<key_t>>& keys,
+                       const std::atomic<bool>* cancel = nullptr) const;
+    virtual size_t nearest(key_t x, key_t y, size_t count,
+                           vector<epstl::pair<key_t>>& keys,
+                           const std::atomic<bool>* cancel = nullptr) const;
+
     virtual void remove(key_t x, key_t y);
     virtual void remove_all(const item_t& item,
                             std::function<bool(const item_t&, const item_t&)> criterion
@@ -241,13 +465,30 @@ class quadtree : public container
     });
 
   protected:
+    /**
+     * @brief Point found by the nearest neighbours search
+     */
+    struct neighbour_t
+    {
+        double squared_distance = 0;
+        position_t position;
+    };
+
     virtual quadrant_t* clone_quadrant(const quadrant_t* quadrant) const;
     virtual void free_quadrant(quadrant_t* quadrant);
+    virtual void free_children(quadrant_t* quadrant);
     virtual bool insert_quadrant(quadrant_t* quadrant, key_t x, key_t y,
                                  const item_t& item);
     virtual quadrant_t** select_quadrant(quadrant_t* quadrant, key_t x,
                                          key_t y) const;
+    virtual bool can_split(const quadrant_t* quadrant) const;
     virtual void create_quadrants(quadrant_t* parent);
+    virtual bool insert_overflow(quadrant_t* quadrant, key_t x, key_t y,
+                                 const item_t& item);
+    virtual bucket_item_t* find_overflow(quadrant_t* quadrant, key_t x,
+                                         key_t y) const;
+    virtual void erase_overflow(quadrant_t* quadrant, bucket_item_t* item);
+    virtual void erase_data(quadrant_t* quadrant);
     virtual const item_t& get_value(quadrant_t* quadrant, key_t x, key_t y) const;
     virtual item_t& get_value(quadrant_t* quadrant, key_t x, key_t y);
     virtual void print_quadrant(std::ostream& stream, quadrant_t* quadrant,
@@ -259,33 +500,59 @@ class quadtree : public container
                                epstl::pair<key_t>& keys,
                                std::function<bool(const item_t&, const item_t&)> criterion) const;
 
+    virtual void range_quadrant(quadrant_t* quadrant, key_t left, key_t bottom,
+                                key_t right, key_t top, vector<epstl::pair<key_t>>& keys,
+                                const std::atomic<bool>* cancel) const;
+    virtual void nearest_quadrant(quadrant_t* quadrant, key_t x, key_t y,
+                                  size_t count, vector<neighbour_t>& neighbours,
+                                  const std::atomic<bool>* cancel) const;
+    static double squared_distance(const rect_bound_t& bound, key_t x, key_t y);
+    static void keep_neighbour(const position_t& position, key_t x, key_t y,
+                               size_t count, vector<neighbour_t>& neighbours);
+
     virtual bool remove_quadrant(quadrant_t* quadrant, key_t x, key_t y);
     virtual bool remove_all_quadrant(quadrant_t* quadrant, const item_t& item,
                                      std::function<bool (const item_t&, const item_t&)> criterion);
+    virtual bool collapse_quadrant(quadrant_t* quadrant);
     virtual size_t compute_depth(quadrant_t* quadrant) const;
+    virtual void update_hash(quadrant_t* quadrant);
+    uint64_t point_hash(const position_t& position, const item_t& item) const;
+    virtual void compute_hash(quadrant_t* quadrant);
+    virtual void diff_quadrant(quadrant_t* quadrant, quadrant_t* other_quadrant,
+                               const quadtree& other, bool use_hash,
+                               vector<epstl::pair<key_t>>& keys) const;
+    virtual void collect_points(quadrant_t* quadrant,
+                                vector<position_t>& points) const;
 
 
 
     quadrant_t* m_root = nullptr;   ///< Root quadrant of the quadtree
     size_t m_size = 0;              ///< Number of points in the tree
-    size_t m_depth = 0;             ///< Depth of the tree
+    mutable size_t m_depth = 0;     ///< Depth of the tree
+    mutable bool m_depth_outdated = false; ///< Quadrants were merged since the depth was computed
     item_t m_default_value;         ///< Default value of the items
     item_t m_exposed_default_value; ///< Default value for mutable reference
     key_t m_height;                 ///< Height of the root quadrant
     key_t m_width;                  ///< Width of the root quadrant
     position_t m_center;            ///< Center of the quadrant
 
+    size_t m_max_depth = 32;        ///< Maximum depth of the quadrants
+    key_t m_min_cell_size = 0;      ///< Minimum width and height of the quadrants
+
     uint8_t m_behaviour_flag = 0;   ///< Behaviour flags
 };
 
 /**
  * @brief Copy constructor
  */
-template<typename key_t, typename item_t>
-quadtree<key_t, item_t>::quadtree(const quadtree<key_t, item_t>& copy) :
-    m_width(copy.m_width), m_height(copy.m_height), m_center(copy.m_center),
-    m_depth(copy.m_depth), m_size(copy.m_size),
-    m_default_value(copy.m_default_value)
+template<typename key_t, typename item_t, typename node_data_t>
+quadtree<key_t, item_t, node_data_t>::quadtree(const quadtree& copy) :
+    m_size(copy.m_size), m_depth(copy.m_depth),
+    m_depth_outdated(copy.m_depth_outdated),
+    m_default_value(copy.m_default_value),
+    m_height(copy.m_height), m_width(copy.m_width), m_center(copy.m_center),
+    m_max_depth(copy.m_max_depth), m_min_cell_size(copy.m_min_cell_size),
+    m_behaviour_flag(copy.m_behaviour_flag)
 {
     m_root = clone_quadrant(copy.m_root);
 }
@@ -293,16 +560,20 @@ quadtree<key_t, item_t>::quadtree(const quadtree<key_t, item_t>& copy) :
 /**
  * @brief Move constructor
  */
-template<typename key_t, typename item_t>
-quadtree<key_t, item_t>::quadtree(quadtree<key_t, item_t>&& move) :
-    m_width(move.m_width), m_height(move.m_height), m_center(move.m_center),
-    m_depth(move.m_depth), m_size(move.m_size),
-    m_default_value(move.m_default_value)
+template<typename key_t, typename item_t, typename node_data_t>
+quadtree<key_t, item_t, node_data_t>::quadtree(quadtree&& move) :
+    m_size(move.m_size), m_depth(move.m_depth),
+    m_depth_outdated(move.m_depth_outdated),
+    m_default_value(move.m_default_value),
+    m_height(move.m_height), m_width(move.m_width), m_center(move.m_center),
+    m_max_depth(move.m_max_depth), m_min_cell_size(move.m_min_cell_size),
+    m_behaviour_flag(move.m_behaviour_flag)
 {
     m_root = move.m_root;
     move.m_root = nullptr;
     move.m_size = 0;
     move.m_depth = 0;
+    move.m_depth_outdated = false;
 }
 
 /**
@@ -310,8 +581,8 @@ quadtree<key_t, item_t>::quadtree(quadtree<key_t, item_t>&& move) :
  *
  * Free all dynamically allocated quadrants
  */
-template<typename key_t, typename item_t>
-quadtree<key_t, item_t>::~quadtree()
+template<typename key_t, typename item_t, typename node_data_t>
+quadtree<key_t, item_t, node_data_t>::~quadtree()
 {
     free_quadrant(m_root);
 }
@@ -319,18 +590,22 @@ quadtree<key_t, item_t>::~quadtree()
 /**
  * @brief Assignation operator
  */
-template<typename key_t, typename item_t>
-quadtree<key_t, item_t>&
-quadtree<key_t, item_t>::operator=(const quadtree& copy)
+template<typename key_t, typename item_t, typename node_data_t>
+quadtree<key_t, item_t, node_data_t>&
+quadtree<key_t, item_t, node_data_t>::operator=(const quadtree& copy)
 {
     m_root = clone_quadrant(copy.m_root);
 
     m_size = copy.m_size;
     m_depth = copy.m_depth;
+    m_depth_outdated = copy.m_depth_outdated;
     m_width = copy.m_width;
     m_height = copy.m_height;
     m_center = copy.m_center;
     m_default_value = copy.m_default_value;
+    m_max_depth = copy.m_max_depth;
+    m_min_cell_size = copy.m_min_cell_size;
+    m_behaviour_flag = copy.m_behaviour_flag;
 
     return *this;
 }
@@ -338,9 +613,9 @@ quadtree<key_t, item_t>::operator=(const quadtree& copy)
 /**
  * @brief Assignation operator with move
  */
-template<typename key_t, typename item_t>
-quadtree<key_t, item_t>&
-quadtree<key_t, item_t>::operator=(quadtree&& move)
+template<typename key_t, typename item_t, typename node_data_t>
+quadtree<key_t, item_t, node_data_t>&
+quadtree<key_t, item_t, node_data_t>::operator=(quadtree&& move)
 {
     m_root = move.m_root;
 
@@ -348,12 +623,17 @@ quadtree<key_t, item_t>::operator=(quadtree&& move)
     move.m_size = 0;
 
     m_depth = move.m_depth;
+    m_depth_outdated = move.m_depth_outdated;
     move.m_depth = 0;
+    move.m_depth_outdated = false;
 
     m_width = move.m_width;
     m_height = move.m_height;
     m_center = move.m_center;
     m_default_value = move.m_default_value;
+    m_max_depth = move.m_max_depth;
+    m_min_cell_size = move.m_min_cell_size;
+    m_behaviour_flag = move.m_behaviour_flag;
 
     return *this;
 }
@@ -361,15 +641,15 @@ quadtree<key_t, item_t>::operator=(quadtree&& move)
 /**
  * @brief Insert the item at the given coordinates
  *
- * Update the depth.
- *
  * @param x X coordinate of the item
  * @param y Y coordinate of the item
  * @param item Item to copy in the tree
  * @return Size of the new tree (number of items)
  */
-template<typename key_t, typename item_t>
-size_t quadtree<key_t, item_t>::insert(key_t x, key_t y, const item_t& item)
+template<typename key_t, typename item_t, typename node_data_t>
+size_t
+quadtree<key_t, item_t, node_data_t>::insert(key_t x, key_t y,
+        const item_t& item)
 {
     if (!m_root)
     {
@@ -383,11 +663,11 @@ size_t quadtree<key_t, item_t>::insert(key_t x, key_t y, const item_t& item)
         m_root->data_position.x = x;
         m_root->data_position.y = y;
         m_size++;
+        update_hash(m_root);
     }
     else
     {
         insert_quadrant(m_root, x, y, item);
-        this->m_depth = compute_depth(m_root);
     }
 
     return m_size;
@@ -402,8 +682,8 @@ size_t quadtree<key_t, item_t>::insert(key_t x, key_t y, const item_t& item)
  * @param y Y coordinate to get
  * @return Constant reference on the value
  */
-template<typename key_t, typename item_t>
-const item_t& quadtree<key_t, item_t>::at(key_t x, key_t y) const
+template<typename key_t, typename item_t, typename node_data_t>
+const item_t& quadtree<key_t, item_t, node_data_t>::at(key_t x, key_t y) const
 {
     return get_value(m_root, x, y);
 }
@@ -418,8 +698,8 @@ const item_t& quadtree<key_t, item_t>::at(key_t x, key_t y) const
  * @param y Y coordinate to get
  * @return Mutable reference on the value
  */
-template<typename key_t, typename item_t>
-item_t& quadtree<key_t, item_t>::at(key_t x, key_t y)
+template<typename key_t, typename item_t, typename node_data_t>
+item_t& quadtree<key_t, item_t, node_data_t>::at(key_t x, key_t y)
 {
     m_exposed_default_value = m_default_value;
     return get_value(m_root, x, y);
@@ -433,9 +713,11 @@ item_t& quadtree<key_t, item_t>::at(key_t x, key_t y)
  * @param criterion Comparaison criterion to apply
  * @return Return true if the item was found
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::find(const item_t& item, epstl::pair<key_t>& keys,
-                                   std::function<bool (const item_t&, const item_t&)> criterion) const
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::find(const item_t& item,
+        epstl::pair<key_t>& keys,
+        std::function<bool (const item_t&, const item_t&)> criterion) const
 {
     return find_quadrant(m_root, item, keys, criterion);
 }
@@ -447,24 +729,91 @@ bool quadtree<key_t, item_t>::find(const item_t& item, epstl::pair<key_t>& keys,
  * @param criterion Comparaison criterion to apply
  * @return Return true if the item was found
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::find(const item_t& item,
+template<typename key_t, typename item_t, typename node_data_t>
+bool quadtree<key_t, item_t, node_data_t>::find(const item_t& item,
                                    std::function<bool (const item_t&, const item_t&)> criterion) const
 {
     epstl::pair<key_t> keys;
     return find(item, keys, criterion);
 }
 
+/**
+ * @brief List the coordinates of the points inside the rectangle
+ *
+ * Only the quadrants overlapping the rectangle are visited.
+ *
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (included)
+ * @param top Top of the rectangle (included)
+ * @param[out] keys Coordinates of the points found, appended
+ * @param cancel Stop the query as soon as it is set, can be null
+ * @return Return the number of points found
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+size_t
+quadtree<key_t, item_t, node_data_t>::query_range(key_t left, key_t bottom,
+        key_t right, key_t top, vector<epstl::pair<key_t>>& keys,
+        const std::atomic<bool>* cancel) const
+{
+    size_t previous_size = keys.size();
+    range_quadrant(m_root, left, bottom, right, top, keys, cancel);
+    return keys.size() - previous_size;
+}
+
+/**
+ * @brief List the coordinates of the points inside the box
+ * @param box Box to search, sides included, x then y
+ * @param[out] keys Coordinates of the points found, appended
+ * @param cancel Stop the query as soon as it is set, can be null
+ * @return Return the number of points found
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+size_t
+quadtree<key_t, item_t, node_data_t>::query_range(const AABB<2, key_t>& box,
+        vector<epstl::pair<key_t>>& keys, const std::atomic<bool>* cancel) const
+{
+    return query_range(box.low.x(), box.low.y(), box.high.x(), box.high.y(),
+                       keys, cancel);
+}
+
+/**
+ * @brief List the coordinates of the nearest points
+ *
+ * The quadrants are visited closest first and skipped when they are further
+ * than the furthest point kept.
+ *
+ * @param x X coordinate of the reference point
+ * @param y Y coordinate of the reference point
+ * @param count Maximum number of points to find
+ * @param[out] keys Coordinates of the points found, closest first, appended
+ * @param cancel Stop the query as soon as it is set, can be null
+ * @return Return the number of points found
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+size_t
+quadtree<key_t, item_t, node_data_t>::nearest(key_t x, key_t y, size_t count,
+        vector<epstl::pair<key_t>>& keys, const std::atomic<bool>* cancel) const
+{
+    if (count == 0)
+        return 0;
+    vector<neighbour_t> neighbours;
+    nearest_quadrant(m_root, x, y, count, neighbours, cancel);
+    for (size_t i = 0; i < neighbours.size(); i++)
+        keys.push_back(epstl::pair<key_t>(neighbours[i].position.x,
+                                          neighbours[i].position.y));
+    return neighbours.size();
+}
+
 /**
  * @brief Remove the item at the given coordinates
  * @param x X coordinate to remove
  * @param y Y coordinate to remove
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::remove(key_t x, key_t y)
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::remove(key_t x, key_t y)
 {
     remove_quadrant(m_root, x, y);
-    m_depth = compute_depth(m_root);
 }
 
 /**
@@ -473,12 +822,11 @@ void quadtree<key_t, item_t>::remove(key_t x, key_t y)
  * @param item Item to remove
  * @param criterion Comparaison criterion to apply
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::remove_all(const item_t& item,
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::remove_all(const item_t& item,
         std::function<bool (const item_t&, const item_t&)> criterion)
 {
     remove_all_quadrant(m_root, item, criterion);
-    m_depth = compute_depth(m_root);
 }
 
 /**
@@ -486,24 +834,28 @@ void quadtree<key_t, item_t>::remove_all(const item_t& item,
  * @param quadrant Quadrant to clone
  * @return Return the pointer on the new quadrant
  */
-template<typename key_t, typename item_t>
-typename quadtree<key_t, item_t>::quadrant_t*
-quadtree<key_t, item_t>::clone_quadrant(const quadrant_t* quadrant) const
+template<typename key_t, typename item_t, typename node_data_t>
+typename quadtree<key_t, item_t, node_data_t>::quadrant_t*
+quadtree<key_t, item_t, node_data_t>::clone_quadrant(
+    const quadrant_t* quadrant) const
 {
     if (quadrant)
     {
         quadrant_t* clone = new quadrant_t;
         clone->parent = nullptr;
-        if (clone->ne = clone_quadrant(quadrant->ne))
-            clone->ne->parent = clone;
-        if (clone->nw = clone_quadrant(quadrant->nw))
-            clone->nw->parent = clone;
-        if (clone->sw = clone_quadrant(quadrant->sw))
-            clone->sw->parent = clone;
-        if (clone->se = clone_quadrant(quadrant->se))
-            clone->se->parent = clone;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            if ((clone->children[i] = clone_quadrant(quadrant->children[i])))
+                clone->children[i]->parent = clone;
+        }
         clone->bound = quadrant->bound;
         clone->data = quadrant->data;
+        clone->data_position = quadrant->data_position;
+        clone->hash = quadrant->hash;
+        clone->level = quadrant->level;
+        static_cast<node_data_t&>(*clone) = *quadrant;
+        if (quadrant->overflow)
+            clone->overflow = new vector<bucket_item_t>(*quadrant->overflow);
         return clone;
     }
     else
@@ -516,20 +868,35 @@ quadtree<key_t, item_t>::clone_quadrant(const quadrant_t* quadrant) const
  * @brief Free the memory of the given quadrant
  * @param quadrant Quadrant to free
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::free_quadrant(quadrant_t* quadrant)
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::free_quadrant(quadrant_t* quadrant)
 {
     if (quadrant)
     {
-        free_quadrant(quadrant->ne);
-        free_quadrant(quadrant->nw);
-        free_quadrant(quadrant->sw);
-        free_quadrant(quadrant->se);
+        for (quadrant_t* child : quadrant->children)
+            free_quadrant(child);
 
+        delete quadrant->overflow;
         delete quadrant;
     }
 }
 
+/**
+ * @brief Free the children of the given quadrant, which becomes a leaf
+ * @param quadrant Quadrant to prune
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::free_children(quadrant_t* quadrant)
+{
+    if (!quadrant->isLeaf())
+        m_depth_outdated = true;
+    for (quadrant_t*& child : quadrant->children)
+    {
+        free_quadrant(child);
+        child = nullptr;
+    }
+}
+
 /**
  * @brief Insert the item on the quadrant at the given coordinates
  *
@@ -539,20 +906,22 @@ void quadtree<key_t, item_t>::free_quadrant(quadrant_t* quadrant)
  * @param item Item to copy into the tree
  * @return true if the quadrant has been changed
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::insert_quadrant(quadrant_t* quadrant, key_t x,
-        key_t y, const item_t& item)
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::insert_quadrant(quadrant_t* quadrant,
+        key_t x, key_t y, const item_t& item)
 {
     if (!quadrant)
         throw epstl::implementation_exception("insertion in a null quadrant");
     if (!quadrant->bound.isInside(x, y))
         return false;
-    if (quadrant->ne) // If there is a quadrant division
+    if (!quadrant->isLeaf()) // If there is a quadrant division
     {
-        return insert_quadrant(quadrant->ne, x, y, item) ||
-               insert_quadrant(quadrant->nw, x, y, item) ||
-               insert_quadrant(quadrant->sw, x, y, item) ||
-               insert_quadrant(quadrant->se, x, y, item);
+        bool modified = insert_quadrant(
+                            quadrant->children[quadrant->bound.childIndex(x, y)], x, y, item);
+        if (modified)
+            update_hash(quadrant);
+        return modified;
     }
 
     if (quadrant->data == m_default_value)
@@ -561,41 +930,50 @@ bool quadtree<key_t, item_t>::insert_quadrant(quadrant_t* quadrant, key_t x,
         quadrant->data_position.x = x;
         quadrant->data_position.y = y;
         m_size++;
+        update_hash(quadrant);
         return true;
     }
 
-    if (quadrant->data_position.x != x || quadrant->data_position.y != y)
+    if (quadrant->data_position.x == x && quadrant->data_position.y == y)
     {
-        // Division
-        create_quadrants(quadrant);
+        if (m_behaviour_flag & quadtree_no_replace)
+            return false;
+        quadrant->data = item;
+        update_hash(quadrant);
+        return true;
+    }
 
-        insert_quadrant(quadrant->ne, quadrant->data_position.x,
-                        quadrant->data_position.y, quadrant->data);
-        insert_quadrant(quadrant->nw, quadrant->data_position.x,
-                        quadrant->data_position.y, quadrant->data);
-        insert_quadrant(quadrant->sw, quadrant->data_position.x,
-                        quadrant->data_position.y, quadrant->data);
-        insert_quadrant(quadrant->se, quadrant->data_position.x,
-                        quadrant->data_position.y, quadrant->data);
-        m_size--;
+    // At the depth or size limit, the leaf keeps the point in its bucket
+    if (!can_split(quadrant))
+        return insert_overflow(quadrant, x, y, item);
 
-        return insert_quadrant(quadrant->ne, x, y, item) ||
-               insert_quadrant(quadrant->nw, x, y, item) ||
-               insert_quadrant(quadrant->sw, x, y, item) ||
-               insert_quadrant(quadrant->se, x, y, item);
+    // Division
+    create_quadrants(quadrant);
 
-    }
-    else
+    const position_t& position = quadrant->data_position;
+    insert_quadrant(quadrant->children[quadrant->bound.childIndex(position.x,
+                                       position.y)], position.x, position.y, quadrant->data);
+    m_size--;
+    if (quadrant->overflow)
     {
-        if (!(m_behaviour_flag & quadtree_no_replace))
+        // The limits were raised since the bucket was filled
+        vector<bucket_item_t>& overflow = *quadrant->overflow;
+        for (size_t i = 0; i < overflow.size(); i++)
         {
-            quadrant->data = item;
-            return true;
+            const position_t& bucket_position = overflow[i].position;
+            insert_quadrant(quadrant->children[quadrant->bound.childIndex(
+                                                   bucket_position.x, bucket_position.y)],
+                            bucket_position.x, bucket_position.y, overflow[i].data);
+            m_size--;
         }
+        delete quadrant->overflow;
+        quadrant->overflow = nullptr;
     }
 
-    return false;
-
+    bool modified = insert_quadrant(
+                        quadrant->children[quadrant->bound.childIndex(x, y)], x, y, item);
+    update_hash(quadrant);
+    return modified;
 }
 
 /**
@@ -605,25 +983,41 @@ bool quadtree<key_t, item_t>::insert_quadrant(quadrant_t* quadrant, key_t x,
  * @param y Y coordinate to look for
  * @return Pointer on the pointer of the selected quadrant
  */
-template<typename key_t, typename item_t>
-typename quadtree<key_t, item_t>::quadrant_t**
-quadtree<key_t, item_t>::select_quadrant(quadrant_t* quadrant, key_t x,
-        key_t y) const
+template<typename key_t, typename item_t, typename node_data_t>
+typename quadtree<key_t, item_t, node_data_t>::quadrant_t**
+quadtree<key_t, item_t, node_data_t>::select_quadrant(quadrant_t* quadrant,
+        key_t x, key_t y) const
 {
     if (!quadrant->bound.isInside(x, y))
         return nullptr;
-    if (x >= quadrant->bound.center.x && y >= quadrant->bound.center.y)
-        return &quadrant->ne;
-    if (x < quadrant->bound.center.x && y >= quadrant->bound.center.y)
-        return &quadrant->nw;
-    if (x >= quadrant->bound.center.x && y < quadrant->bound.center.y)
-        return &quadrant->se;
-    if (x < quadrant->bound.center.x && y < quadrant->bound.center.y)
-        return &quadrant->sw;
-    return nullptr;
+    return &quadrant->children[quadrant->bound.childIndex(x, y)];
 
 }
 
+/**
+ * @brief Tells if the quadrant can be divided
+ *
+ * The division is refused at the maximum depth, when the children would be
+ * smaller than the minimum cell size, or when the center can not be
+ * distinguished from the sides (close floating points, unit integer cells).
+ * @param quadrant Quadrant to divide
+ * @return Return true if the quadrant can be divided
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::can_split(
+    const quadrant_t* quadrant) const
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (quadrant->level >= m_max_depth)
+        return false;
+    if (bound.right - bound.left < 2 * m_min_cell_size ||
+            bound.top - bound.bottom < 2 * m_min_cell_size)
+        return false;
+    return (bound.left < bound.center.x && bound.center.x < bound.right) ||
+           (bound.bottom < bound.center.y && bound.center.y < bound.top);
+}
+
 /**
  * @brief Create the quadrant children of the parent
  *
@@ -631,55 +1025,149 @@ quadtree<key_t, item_t>::select_quadrant(quadrant_t* quadrant, key_t x,
  * @todo What happens if we can't devide by 2 ? Ex: parent quadrant is already 1x1 and key_t is int.
  * @warning Dynamic allocation with new operator
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::create_quadrants(quadrant_t* parent)
-{
-    quadrant_t* ne = new quadrant_t;
-    ne->parent = parent;
-    ne->data = m_default_value;
-    ne->bound.left = parent->bound.center.x;
-    ne->bound.right = parent->bound.right;
-    ne->bound.top = parent->bound.top;
-    ne->bound.bottom = parent->bound.center.y;
-    ne->bound.center.x = (ne->bound.left + ne->bound.right) / 2.;
-    ne->bound.center.y = (ne->bound.top + ne->bound.bottom) / 2.;
-    parent->ne = ne;
-
-    quadrant_t* nw = new quadrant_t;
-    nw->parent = parent;
-    nw->data = m_default_value;
-    nw->bound.left = parent->bound.left;
-    nw->bound.right = parent->bound.center.x;
-    nw->bound.top = parent->bound.top;
-    nw->bound.bottom = parent->bound.center.y;
-    nw->bound.center.x = (nw->bound.left + nw->bound.right) / 2.;
-    nw->bound.center.y = (nw->bound.top + nw->bound.bottom) / 2.;
-    parent->nw = nw;
-
-    quadrant_t* sw = new quadrant_t;
-    sw->parent = parent;
-    sw->data = m_default_value;
-    sw->bound.left = parent->bound.left;
-    sw->bound.right = parent->bound.center.x;
-    sw->bound.top = parent->bound.center.y;
-    sw->bound.bottom = parent->bound.bottom;
-    sw->bound.center.x = (sw->bound.left + sw->bound.right) / 2.;
-    sw->bound.center.y = (sw->bound.top + sw->bound.bottom) / 2.;
-    parent->sw = sw;
-
-    quadrant_t* se = new quadrant_t;
-    se->parent = parent;
-    se->data = m_default_value;
-    se->bound.left = parent->bound.center.x;
-    se->bound.right = parent->bound.right;
-    se->bound.top = parent->bound.center.y;
-    se->bound.bottom = parent->bound.bottom;
-    se->bound.center.x = (se->bound.left + se->bound.right) / 2.;
-    se->bound.center.y = (se->bound.top + se->bound.bottom) / 2.;
-    parent->se = se;
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::create_quadrants(quadrant_t* parent)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        quadrant_t* child = new quadrant_t;
+        child->parent = parent;
+        child->level = parent->level + 1;
+        if (child->level > m_depth)
+            m_depth = child->level;
+        child->data = m_default_value;
+        if (i & quadrant_se) // East
+        {
+            child->bound.left = parent->bound.center.x;
+            child->bound.right = parent->bound.right;
+        }
+        else
+        {
+            child->bound.left = parent->bound.left;
+            child->bound.right = parent->bound.center.x;
+        }
+        if (i & quadrant_nw) // North
+        {
+            child->bound.bottom = parent->bound.center.y;
+            child->bound.top = parent->bound.top;
+        }
+        else
+        {
+            child->bound.bottom = parent->bound.bottom;
+            child->bound.top = parent->bound.center.y;
+        }
+        child->bound.center.x = (child->bound.left + child->bound.right) / 2.;
+        child->bound.center.y = (child->bound.top + child->bound.bottom) / 2.;
+        parent->children[i] = child;
+    }
 
 }
 
+/**
+ * @brief Insert the item in the overflow bucket of the leaf
+ *
+ * The leaf already holds a point at another position.
+ * @param quadrant Leaf which can not be divided
+ * @param x X coordinate of the item to insert
+ * @param y Y coordinate of the item to insert
+ * @param item Item to copy into the tree
+ * @return true if the quadrant has been changed
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::insert_overflow(quadrant_t* quadrant,
+        key_t x, key_t y, const item_t& item)
+{
+    if (bucket_item_t* bucket_item = find_overflow(quadrant, x, y))
+    {
+        if (m_behaviour_flag & quadtree_no_replace)
+            return false;
+        bucket_item->data = item;
+    }
+    else
+    {
+        if (!quadrant->overflow)
+            quadrant->overflow = new vector<bucket_item_t>;
+        bucket_item_t new_item;
+        new_item.position.x = x;
+        new_item.position.y = y;
+        new_item.data = item;
+        quadrant->overflow->push_back(new_item);
+        m_size++;
+    }
+    update_hash(quadrant);
+    return true;
+}
+
+/**
+ * @brief Look for the point at the given coordinates in the bucket of the leaf
+ * @param quadrant Leaf to look into
+ * @param x X coordinate to look for
+ * @param y Y coordinate to look for
+ * @return Pointer on the point found, null if there is none
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+typename quadtree<key_t, item_t, node_data_t>::bucket_item_t*
+quadtree<key_t, item_t, node_data_t>::find_overflow(quadrant_t* quadrant,
+        key_t x, key_t y) const
+{
+    if (!quadrant->overflow)
+        return nullptr;
+    vector<bucket_item_t>& overflow = *quadrant->overflow;
+    for (size_t i = 0; i < overflow.size(); i++)
+    {
+        if (overflow[i].position.x == x && overflow[i].position.y == y)
+            return &overflow[i];
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Remove the point from the bucket of the leaf
+ *
+ * The last point of the bucket takes its place. The bucket is freed when it
+ * is empty.
+ * @param quadrant Leaf holding the bucket
+ * @param item Point of the bucket to remove
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::erase_overflow(quadrant_t* quadrant,
+        bucket_item_t* item)
+{
+    vector<bucket_item_t>& overflow = *quadrant->overflow;
+    *item = overflow[overflow.size() - 1];
+    overflow.pop_back();
+    if (overflow.size() == 0)
+    {
+        delete quadrant->overflow;
+        quadrant->overflow = nullptr;
+    }
+}
+
+/**
+ * @brief Remove the main point of the leaf
+ *
+ * A point of the bucket takes its place, if there is one.
+ * @param quadrant Leaf to empty
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::erase_data(quadrant_t* quadrant)
+{
+    if (quadrant->overflow)
+    {
+        vector<bucket_item_t>& overflow = *quadrant->overflow;
+        bucket_item_t* last = &overflow[overflow.size() - 1];
+        quadrant->data = last->data;
+        quadrant->data_position = last->position;
+        erase_overflow(quadrant, last);
+    }
+    else
+    {
+        quadrant->data = m_default_value;
+        quadrant->data_position = {};
+    }
+}
+
 /**
  * @brief Get the value at the given position
  *
@@ -689,13 +1177,14 @@ void quadtree<key_t, item_t>::create_quadrants(quadrant_t* parent)
  * @param y Y coordinate to look for
  * @return Constant reference on the value
  */
-template<typename key_t, typename item_t>
-const item_t& quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x,
+template<typename key_t, typename item_t, typename node_data_t>
+const item_t&
+quadtree<key_t, item_t, node_data_t>::get_value(quadrant_t* quadrant, key_t x,
         key_t y) const
 {
-    if (!quadrant->bound.isInside(x, y))
+    if (!quadrant || !quadrant->bound.isInside(x, y))
         return m_default_value;
-    if (quadrant->ne)
+    if (!quadrant->isLeaf())
     {
         quadrant_t** selected_quadrant = select_quadrant(quadrant, x, y);
         if (!selected_quadrant)
@@ -706,8 +1195,9 @@ const item_t& quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x,
     {
         if (quadrant->data_position.x == x && quadrant->data_position.y == y)
             return quadrant->data;
-        else
-            return m_default_value;
+        if (const bucket_item_t* bucket_item = find_overflow(quadrant, x, y))
+            return bucket_item->data;
+        return m_default_value;
     }
 }
 
@@ -723,13 +1213,14 @@ const item_t& quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x,
  * @param y Y coordinate to look for
  * @return Mutable reference on the value
  */
-template<typename key_t, typename item_t>
+template<typename key_t, typename item_t, typename node_data_t>
 item_t&
-quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x, key_t y)
+quadtree<key_t, item_t, node_data_t>::get_value(quadrant_t* quadrant, key_t x,
+        key_t y)
 {
-    if (!quadrant->bound.isInside(x, y))
+    if (!quadrant || !quadrant->bound.isInside(x, y))
         return m_exposed_default_value;
-    if (quadrant->ne)
+    if (!quadrant->isLeaf())
     {
         quadrant_t** selected_quadrant = select_quadrant(quadrant, x, y);
         if (!selected_quadrant)
@@ -740,8 +1231,9 @@ quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x, key_t y)
     {
         if (quadrant->data_position.x == x && quadrant->data_position.y == y)
             return quadrant->data;
-        else
-            return m_exposed_default_value;
+        if (bucket_item_t* bucket_item = find_overflow(quadrant, x, y))
+            return bucket_item->data;
+        return m_exposed_default_value;
     }
 }
 
@@ -752,8 +1244,8 @@ quadtree<key_t, item_t>::get_value(quadrant_t* quadrant, key_t x, key_t y)
  * @param quadrant Quadrant to print
  * @param shifts Shifts to apply
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::print_quadrant(std::ostream& stream,
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::print_quadrant(std::ostream& stream,
         quadrant_t* quadrant, uint32_t shifts) const
 {
     if (quadrant)
@@ -761,20 +1253,20 @@ void quadtree<key_t, item_t>::print_quadrant(std::ostream& stream,
         shift_stream(stream, shifts, "| ");
         stream << "[ " << quadrant->bound.left << ", " << quadrant->bound.right <<
                " ], [ " << quadrant->bound.bottom << ", " << quadrant->bound.top << " ]\n";
-        if (quadrant->ne)
+        if (!quadrant->isLeaf())
         {
             shift_stream(stream, shifts, "| ");
             stream << "NE : \n";
-            print_quadrant(stream, quadrant->ne, shifts + 1);
+            print_quadrant(stream, quadrant->children[quadrant_ne], shifts + 1);
             shift_stream(stream, shifts, "| ");
             stream << "NW : \n";
-            print_quadrant(stream, quadrant->nw, shifts + 1);
+            print_quadrant(stream, quadrant->children[quadrant_nw], shifts + 1);
             shift_stream(stream, shifts, "| ");
             stream << "SW : \n";
-            print_quadrant(stream, quadrant->sw, shifts + 1);
+            print_quadrant(stream, quadrant->children[quadrant_sw], shifts + 1);
             shift_stream(stream, shifts, "| ");
             stream << "SE : \n";
-            print_quadrant(stream, quadrant->se, shifts + 1);
+            print_quadrant(stream, quadrant->children[quadrant_se], shifts + 1);
             shift_stream(stream, shifts, "| ");
             stream << "-\n";
         }
@@ -785,6 +1277,16 @@ void quadtree<key_t, item_t>::print_quadrant(std::ostream& stream,
             shift_stream(stream, shifts, "| ");
             stream << "Data position : " << quadrant->data_position.x << ", " <<
                    quadrant->data_position.y << "\n";
+            if (quadrant->overflow)
+            {
+                const vector<bucket_item_t>& overflow = *quadrant->overflow;
+                for (size_t i = 0; i < overflow.size(); i++)
+                {
+                    shift_stream(stream, shifts, "| ");
+                    stream << "Overflow : " << overflow[i].data << " at " <<
+                           overflow[i].position.x << ", " << overflow[i].position.y << "\n";
+                }
+            }
         }
 
     }
@@ -797,8 +1299,8 @@ void quadtree<key_t, item_t>::print_quadrant(std::ostream& stream,
  * @param shifts Number of separator to print
  * @param separator Separator to print. Use '\t' for tabulation for example
  */
-template<typename key_t, typename item_t>
-void quadtree<key_t, item_t>::shift_stream(std::ostream& stream,
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::shift_stream(std::ostream& stream,
         uint32_t shifts, const char* separator) const
 {
     for (uint32_t i = 0; i < shifts; i++)
@@ -814,29 +1316,33 @@ void quadtree<key_t, item_t>::shift_stream(std::ostream& stream,
  * @param[out] keys Output for the coordinates of the item if it was found
  * @param criterion Comparaison criterion to apply
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::find_quadrant(quadrant_t* quadrant,
+template<typename key_t, typename item_t, typename node_data_t>
+bool quadtree<key_t, item_t, node_data_t>::find_quadrant(quadrant_t* quadrant,
         const item_t& item, epstl::pair<key_t>& keys,
         std::function<bool (const item_t&, const item_t&)> criterion) const
 {
     if (!quadrant)
         return false;
-    if (quadrant->ne)
+    if (!quadrant->isLeaf())
     {
         if (m_behaviour_flag & epstl::quadtree_multithread)
         {
             // TODO
-            return find_quadrant(quadrant->ne, item, keys, criterion) ||
-                   find_quadrant(quadrant->nw, item, keys, criterion) ||
-                   find_quadrant(quadrant->sw, item, keys, criterion) ||
-                   find_quadrant(quadrant->se, item, keys, criterion);
+            for (quadrant_t* child : quadrant->children)
+            {
+                if (find_quadrant(child, item, keys, criterion))
+                    return true;
+            }
+            return false;
         }
         else
         {
-            return find_quadrant(quadrant->ne, item, keys, criterion) ||
-                   find_quadrant(quadrant->nw, item, keys, criterion) ||
-                   find_quadrant(quadrant->sw, item, keys, criterion) ||
-                   find_quadrant(quadrant->se, item, keys, criterion);
+            for (quadrant_t* child : quadrant->children)
+            {
+                if (find_quadrant(child, item, keys, criterion))
+                    return true;
+            }
+            return false;
         }
     }
     else if (criterion(quadrant->data, item))
@@ -845,83 +1351,229 @@ bool quadtree<key_t, item_t>::find_quadrant(quadrant_t* quadrant,
         keys.second = quadrant->data_position.y;
         return true;
     }
-    else
+    else if (quadrant->overflow)
     {
-        return false;
+        const vector<bucket_item_t>& overflow = *quadrant->overflow;
+        for (size_t i = 0; i < overflow.size(); i++)
+        {
+            if (criterion(overflow[i].data, item))
+            {
+                keys.first = overflow[i].position.x;
+                keys.second = overflow[i].position.y;
+                return true;
+            }
+        }
     }
+    return false;
 }
 
 /**
- * @brief Recursive method for remove method
+ * @brief Recursive method for query_range
  *
  * @param quadrant Quadrant to look into
- * @param x X coordinate to look for
- * @param y Y coordinate to look for
- * @return Return true if the qudrant is left empty
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (included)
+ * @param top Top of the rectangle (included)
+ * @param[out] keys Coordinates of the points found
+ * @param cancel Stop the query as soon as it is set, can be null
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::remove_quadrant(quadrant_t* quadrant, key_t x,
-        key_t y)
+template<typename key_t, typename item_t, typename node_data_t>
+void
+quadtree<key_t, item_t, node_data_t>::range_quadrant(quadrant_t* quadrant,
+        key_t left, key_t bottom, key_t right, key_t top,
+        vector<epstl::pair<key_t>>& keys, const std::atomic<bool>* cancel) const
 {
-    if (!quadrant)
-        return true;
-    if (quadrant->ne)
+    if (!quadrant || (cancel && cancel->load(std::memory_order_relaxed)))
+        return;
+    if (!quadrant->isLeaf())
     {
-        bool ne_empty = remove_quadrant(quadrant->ne, x, y);
-        bool nw_empty = remove_quadrant(quadrant->nw, x, y);
-        bool sw_empty = remove_quadrant(quadrant->sw, x, y);
-        bool se_empty = remove_quadrant(quadrant->se, x, y);
-
-        if (ne_empty || nw_empty || sw_empty || se_empty)
+        uint8_t mask = quadrant->bound.childrenMask(left, bottom, right, top);
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            if (mask & (1 << i))
+                range_quadrant(quadrant->children[i], left, bottom, right, top, keys,
+                               cancel);
+        }
+    }
+    else if (!(quadrant->data == m_default_value))
+    {
+        const position_t& position = quadrant->data_position;
+        if (position.x >= left && position.x <= right && position.y >= bottom &&
+                position.y <= top)
+            keys.push_back(epstl::pair<key_t>(position.x, position.y));
+        if (quadrant->overflow)
         {
-            // If all quadrants are empty, the parent is empty too
-            if (ne_empty && nw_empty && sw_empty && se_empty)
+            const vector<bucket_item_t>& overflow = *quadrant->overflow;
+            for (size_t i = 0; i < overflow.size(); i++)
             {
-                quadrant->ne = nullptr;
-                quadrant->nw = nullptr;
-                quadrant->sw = nullptr;
-                quadrant->se = nullptr;
-                quadrant->data = m_default_value;
-                quadrant->data_position = {};
-                return true;
+                const position_t& bucket_position = overflow[i].position;
+                if (bucket_position.x >= left && bucket_position.x <= right &&
+                        bucket_position.y >= bottom && bucket_position.y <= top)
+                    keys.push_back(epstl::pair<key_t>(bucket_position.x, bucket_position.y));
             }
-            // Else, if only 1 quadrant is not empty, we bring up the data and
-            // delete the 4 quadrants
-            else if (ne_empty + nw_empty + sw_empty + se_empty == 3)
+        }
+    }
+}
+
+/**
+ * @brief Recursive method for nearest
+ *
+ * @param quadrant Quadrant to look into
+ * @param x X coordinate of the reference point
+ * @param y Y coordinate of the reference point
+ * @param count Maximum number of points to find
+ * @param[in,out] neighbours Points kept, sorted by distance
+ * @param cancel Stop the query as soon as it is set, can be null
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void
+quadtree<key_t, item_t, node_data_t>::nearest_quadrant(quadrant_t* quadrant,
+        key_t x, key_t y, size_t count, vector<neighbour_t>& neighbours,
+        const std::atomic<bool>* cancel) const
+{
+    if (!quadrant || (cancel && cancel->load(std::memory_order_relaxed)))
+        return;
+    if (neighbours.size() == count &&
+            squared_distance(quadrant->bound, x, y) >
+            neighbours[neighbours.size() - 1].squared_distance)
+        return;
+
+    if (!quadrant->isLeaf())
+    {
+        // Visit the closest children first
+        double distances[4];
+        uint8_t order[4] = {0, 1, 2, 3};
+        for (uint8_t i = 0; i < 4; i++)
+            distances[i] = squared_distance(quadrant->children[i]->bound, x, y);
+        for (uint8_t i = 1; i < 4; i++)
+        {
+            for (uint8_t j = i; j > 0 && distances[order[j]] < distances[order[j - 1]];
+                    j--)
             {
-                quadrant_t* not_empty_one = nullptr;
-                if (!ne_empty)
-                    not_empty_one = quadrant->ne;
-                else if (!nw_empty)
-                    not_empty_one = quadrant->nw;
-                else if (!sw_empty)
-                    not_empty_one = quadrant->sw;
-                else
-                    not_empty_one = quadrant->se;
-
-                quadrant->data = not_empty_one->data;
-                quadrant->data_position = not_empty_one->data_position;
-
-                quadrant->ne = nullptr;
-                quadrant->nw = nullptr;
-                quadrant->sw = nullptr;
-                quadrant->se = nullptr;
-                return false;
+                uint8_t tmp = order[j];
+                order[j] = order[j - 1];
+                order[j - 1] = tmp;
             }
         }
-        return false;
+        for (uint8_t i : order)
+            nearest_quadrant(quadrant->children[i], x, y, count, neighbours, cancel);
     }
-    else if (quadrant->data_position.x == x && quadrant->data_position.y == y)
+    else if (!(quadrant->data == m_default_value))
     {
-        quadrant->data = m_default_value;
-        quadrant->data_position = {};
-        m_size--;
+        keep_neighbour(quadrant->data_position, x, y, count, neighbours);
+        if (quadrant->overflow)
+        {
+            const vector<bucket_item_t>& overflow = *quadrant->overflow;
+            for (size_t i = 0; i < overflow.size(); i++)
+                keep_neighbour(overflow[i].position, x, y, count, neighbours);
+        }
+    }
+}
+
+/**
+ * @brief Add the point to the nearest neighbours if it is close enough
+ *
+ * @param position Position of the point
+ * @param x X coordinate of the reference point
+ * @param y Y coordinate of the reference point
+ * @param count Maximum number of points to keep
+ * @param[in,out] neighbours Points kept, sorted by distance
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void
+quadtree<key_t, item_t, node_data_t>::keep_neighbour(const position_t& position,
+        key_t x, key_t y, size_t count, vector<neighbour_t>& neighbours)
+{
+    neighbour_t neighbour;
+    double dx = static_cast<double>(position.x) - x;
+    double dy = static_cast<double>(position.y) - y;
+    neighbour.squared_distance = dx * dx + dy * dy;
+    neighbour.position = position;
+    if (neighbours.size() == count)
+    {
+        if (neighbour.squared_distance >=
+                neighbours[neighbours.size() - 1].squared_distance)
+            return;
+        neighbours.pop_back();
+    }
+    // Insertion in the sorted list
+    neighbours.push_back(neighbour);
+    for (size_t i = neighbours.size() - 1;
+            i > 0 && neighbours[i].squared_distance < neighbours[i - 1].squared_distance;
+            i--)
+    {
+        neighbour_t tmp = neighbours[i];
+        neighbours[i] = neighbours[i - 1];
+        neighbours[i - 1] = tmp;
+    }
+}
+
+/**
+ * @brief Squared distance between the point and the bounds
+ * @param bound Bounds to measure
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @return Return 0 if the point is inside the bounds
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+double
+quadtree<key_t, item_t, node_data_t>::squared_distance(
+    const rect_bound_t& bound, key_t x, key_t y)
+{
+    double dx = 0;
+    double dy = 0;
+    if (x < bound.left)
+        dx = static_cast<double>(bound.left) - x;
+    else if (x > bound.right)
+        dx = static_cast<double>(x) - bound.right;
+    if (y < bound.bottom)
+        dy = static_cast<double>(bound.bottom) - y;
+    else if (y > bound.top)
+        dy = static_cast<double>(y) - bound.top;
+    return dx * dx + dy * dy;
+}
+
+/**
+ * @brief Recursive method for remove method
+ *
+ * @param quadrant Quadrant to look into
+ * @param x X coordinate to look for
+ * @param y Y coordinate to look for
+ * @return Return true if the qudrant is left empty
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::remove_quadrant(quadrant_t* quadrant,
+        key_t x, key_t y)
+{
+    if (!quadrant)
         return true;
+    if (!quadrant->isLeaf())
+    {
+        // Only the child containing the coordinates can be modified
+        if (quadrant->bound.isInside(x, y))
+            remove_quadrant(quadrant->children[quadrant->bound.childIndex(x, y)], x,
+                            y);
+        return collapse_quadrant(quadrant);
     }
     else if (quadrant->data == m_default_value)
     {
         return true;
     }
+    else if (quadrant->data_position.x == x && quadrant->data_position.y == y)
+    {
+        erase_data(quadrant);
+        m_size--;
+        update_hash(quadrant);
+        return quadrant->data == m_default_value;
+    }
+    else if (bucket_item_t* bucket_item = find_overflow(quadrant, x, y))
+    {
+        erase_overflow(quadrant, bucket_item);
+        m_size--;
+        update_hash(quadrant);
+    }
     return false;
 }
 
@@ -932,70 +1584,89 @@ bool quadtree<key_t, item_t>::remove_quadrant(quadrant_t* quadrant, key_t x,
  * @param criterion Comparaison criterion to apply
  * @return Return true if the quadrant was left empty
  */
-template<typename key_t, typename item_t>
-bool quadtree<key_t, item_t>::remove_all_quadrant(quadrant_t* quadrant,
-        const item_t& item, std::function<bool (const item_t&, const item_t&)>
-        criterion)
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::remove_all_quadrant(quadrant_t* quadrant,
+        const item_t& item, std::function<bool (const item_t&,
+        const item_t&)> criterion)
 {
     if (!quadrant)
         return true;
-    if (quadrant->ne)
+    if (!quadrant->isLeaf())
+    {
+        for (quadrant_t* child : quadrant->children)
+            remove_all_quadrant(child, item, criterion);
+        return collapse_quadrant(quadrant);
+    }
+    else if (quadrant->data == m_default_value)
+    {
+        return true;
+    }
+    size_t previous_size = m_size;
+    // From the end: the erased points are replaced by the last ones
+    for (size_t i = quadrant->overflow ? quadrant->overflow->size() : 0; i-- > 0;)
+    {
+        bucket_item_t* bucket_item = &(*quadrant->overflow)[i];
+        if (criterion(bucket_item->data, item))
+        {
+            erase_overflow(quadrant, bucket_item);
+            m_size--;
+        }
+    }
+    if (criterion(quadrant->data, item))
     {
-        bool ne_empty = remove_all_quadrant(quadrant->ne, item, criterion);
-        bool nw_empty = remove_all_quadrant(quadrant->nw, item, criterion);
-        bool sw_empty = remove_all_quadrant(quadrant->sw, item, criterion);
-        bool se_empty = remove_all_quadrant(quadrant->se, item, criterion);
+        erase_data(quadrant);
+        m_size--;
+    }
+    if (m_size != previous_size)
+        update_hash(quadrant);
+    return quadrant->data == m_default_value;
+}
 
-        if (ne_empty || nw_empty || sw_empty || se_empty)
+/**
+ * @brief Merge the children of the quadrant after a removal
+ *
+ * If all the children are empty, the quadrant becomes an empty leaf. If only
+ * one child holds a point, the point is brought up and the children are
+ * deleted. The children need to be up to date.
+ *
+ * @param quadrant Divided quadrant to merge
+ * @return Return true if the quadrant is left empty
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+bool
+quadtree<key_t, item_t, node_data_t>::collapse_quadrant(quadrant_t* quadrant)
+{
+    quadrant_t* not_empty_one = nullptr;
+    uint8_t not_empty_count = 0;
+    for (quadrant_t* child : quadrant->children)
+    {
+        if (!child->isLeaf() || !(child->data == m_default_value))
         {
-            // If all quadrants are empty, the parent is empty too
-            if (ne_empty && nw_empty && sw_empty && se_empty)
-            {
-                quadrant->ne = nullptr;
-                quadrant->nw = nullptr;
-                quadrant->sw = nullptr;
-                quadrant->se = nullptr;
-                quadrant->data = m_default_value;
-                quadrant->data_position = {};
-                return true;
-            }
-            // Else, if only 1 quadrant is not empty, we bring up the data and
-            // delete the 4 quadrants
-            else if (ne_empty + nw_empty + sw_empty + se_empty == 3)
-            {
-                quadrant_t* not_empty_one = nullptr;
-                if (!ne_empty)
-                    not_empty_one = quadrant->ne;
-                else if (!nw_empty)
-                    not_empty_one = quadrant->nw;
-                else if (!sw_empty)
-                    not_empty_one = quadrant->sw;
-                else
-                    not_empty_one = quadrant->se;
-
-                quadrant->data = not_empty_one->data;
-                quadrant->data_position = not_empty_one->data_position;
-
-                quadrant->ne = nullptr;
-                quadrant->nw = nullptr;
-                quadrant->sw = nullptr;
-                quadrant->se = nullptr;
-                return false;
-            }
+            not_empty_one = child;
+            not_empty_count++;
         }
-        return false;
     }
-    else if (criterion(quadrant->data, item))
+
+    // If all quadrants are empty, the parent is empty too
+    if (not_empty_count == 0)
     {
+        free_children(quadrant);
         quadrant->data = m_default_value;
         quadrant->data_position = {};
-        m_size--;
+        update_hash(quadrant);
         return true;
     }
-    else if (quadrant->data == m_default_value)
+    // Else, if only 1 quadrant is not empty and holds a single point, we bring
+    // up the data and delete the 4 quadrants
+    if (not_empty_count == 1 && not_empty_one->isLeaf() &&
+            !not_empty_one->overflow)
     {
-        return true;
+        quadrant->data = not_empty_one->data;
+        quadrant->data_position = not_empty_one->data_position;
+        free_children(quadrant);
     }
+    update_hash(quadrant);
     return false;
 }
 
@@ -1004,19 +1675,191 @@ bool quadtree<key_t, item_t>::remove_all_quadrant(quadrant_t* quadrant,
  * @param quadrant Quadrant where to compute the depth
  * @return Return the depth of the given quarant
  */
-template<typename key_t, typename item_t>
-size_t quadtree<key_t, item_t>::compute_depth(quadrant_t* quadrant) const
+template<typename key_t, typename item_t, typename node_data_t>
+size_t
+quadtree<key_t, item_t, node_data_t>::compute_depth(quadrant_t* quadrant) const
 {
     if (!quadrant)
         return 0;
-    if (quadrant->ne)
-        return epstl::max(compute_depth(quadrant->ne),
-                          compute_depth(quadrant->nw),
-                          compute_depth(quadrant->sw),
-                          compute_depth(quadrant->se)) + 1;
+    if (!quadrant->isLeaf())
+        return epstl::max(compute_depth(quadrant->children[quadrant_sw]),
+                          compute_depth(quadrant->children[quadrant_se]),
+                          compute_depth(quadrant->children[quadrant_nw]),
+                          compute_depth(quadrant->children[quadrant_ne])) + 1;
 
     return 0;
 }
 
+/**
+ * @brief List the coordinates where the two trees have different items
+ *
+ * With the quadtree_hash behaviour flag set on both trees, only the
+ * quadrants with different hashes are visited, so the cost depends on the
+ * number of differences and not on the size of the trees. Else, all the
+ * points of both trees are compared.
+ *
+ * @param other Tree to compare with
+ * @param[out] keys Coordinates of the differing points
+ * @return Return the number of differing points
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+size_t quadtree<key_t, item_t, node_data_t>::diff(const quadtree& other,
+                                     vector<epstl::pair<key_t>>& keys) const
+{
+    size_t previous_size = keys.size();
+    bool use_hash = (m_behaviour_flag & quadtree_hash) &&
+                    (other.m_behaviour_flag & quadtree_hash);
+    diff_quadrant(m_root, other.m_root, other, use_hash, keys);
+    return keys.size() - previous_size;
+}
+
+/**
+ * @brief Update the hash of the quadrant from its data or its children
+ *
+ * Only the given quadrant is updated: its children need to be up to date.
+ * Do nothing if the quadtree_hash behaviour flag is not set.
+ *
+ * @param quadrant Quadrant to update
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::update_hash(quadrant_t* quadrant)
+{
+    if (!quadrant || !(m_behaviour_flag & quadtree_hash))
+        return;
+    if (!quadrant->isLeaf())
+    {
+        // Sum of the children: the hash does not depend on the division
+        quadrant->hash = 0;
+        for (quadrant_t* child : quadrant->children)
+            quadrant->hash += child->hash;
+    }
+    else if (quadrant->data == m_default_value)
+    {
+        quadrant->hash = 0;
+    }
+    else
+    {
+        quadrant->hash = point_hash(quadrant->data_position, quadrant->data);
+        if (quadrant->overflow)
+        {
+            const vector<bucket_item_t>& overflow = *quadrant->overflow;
+            for (size_t i = 0; i < overflow.size(); i++)
+                quadrant->hash += point_hash(overflow[i].position, overflow[i].data);
+        }
+    }
+}
+
+/**
+ * @brief Hash of a single point
+ * @param position Position of the point
+ * @param item Item of the point
+ * @return Return the hash of the point
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+uint64_t
+quadtree<key_t, item_t, node_data_t>::point_hash(const position_t& position,
+        const item_t& item) const
+{
+    uint64_t hash = hash_combine(hash_value(position.x), hash_value(position.y));
+    // Never reached for other items: set_behaviour_flag refuses quadtree_hash
+    if constexpr (is_hashable<item_t>::value)
+        hash = hash_combine(hash, hash_value(item));
+    return hash_mix(hash);
+}
+
+/**
+ * @brief Recursive method to compute the hash of the quadrant and its children
+ * @param quadrant Quadrant to compute
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::compute_hash(quadrant_t* quadrant)
+{
+    if (!quadrant)
+        return;
+    for (quadrant_t* child : quadrant->children)
+        compute_hash(child);
+    update_hash(quadrant);
+}
+
+/**
+ * @brief Recursive method for diff
+ *
+ * @param quadrant Quadrant of this tree
+ * @param other_quadrant Quadrant of the other tree covering the same area
+ * @param other Other tree
+ * @param use_hash Skip the quadrants with equal hashes
+ * @param[out] keys Coordinates of the differing points
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::diff_quadrant(quadrant_t* quadrant,
+        quadrant_t* other_quadrant, const quadtree& other, bool use_hash,
+        vector<epstl::pair<key_t>>& keys) const
+{
+    if (!quadrant && !other_quadrant)
+        return;
+    if (use_hash && quadrant && other_quadrant &&
+            quadrant->hash == other_quadrant->hash)
+        return;
+    if (quadrant && other_quadrant && !quadrant->isLeaf() &&
+            !other_quadrant->isLeaf() &&
+            quadrant->bound.left == other_quadrant->bound.left &&
+            quadrant->bound.right == other_quadrant->bound.right &&
+            quadrant->bound.bottom == other_quadrant->bound.bottom &&
+            quadrant->bound.top == other_quadrant->bound.top)
+    {
+        for (uint8_t i = 0; i < 4; i++)
+            diff_quadrant(quadrant->children[i], other_quadrant->children[i], other,
+                          use_hash, keys);
+        return;
+    }
+
+    // One of the sides is not divided: compare the points one by one
+    vector<position_t> points;
+    collect_points(quadrant, points);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const position_t& point = points[i];
+        const item_t& item = get_value(quadrant, point.x, point.y);
+        if (!other_quadrant || !(other.get_value(other_quadrant, point.x,
+                                 point.y) == item))
+            keys.push_back(epstl::pair<key_t>(point.x, point.y));
+    }
+    vector<position_t> other_points;
+    other.collect_points(other_quadrant, other_points);
+    for (size_t i = 0; i < other_points.size(); i++)
+    {
+        const position_t& point = other_points[i];
+        if (!quadrant || get_value(quadrant, point.x, point.y) == m_default_value)
+            keys.push_back(epstl::pair<key_t>(point.x, point.y));
+    }
+}
+
+/**
+ * @brief Recursive method to list the positions of the points of a quadrant
+ * @param quadrant Quadrant to look into
+ * @param[out] points Positions of the points
+ */
+template<typename key_t, typename item_t, typename node_data_t>
+void quadtree<key_t, item_t, node_data_t>::collect_points(quadrant_t* quadrant,
+        vector<position_t>& points) const
+{
+    if (!quadrant)
+        return;
+    if (!quadrant->isLeaf())
+    {
+        for (quadrant_t* child : quadrant->children)
+            collect_points(child, points);
+    }
+    else if (!(quadrant->data == m_default_value))
+    {
+        points.push_back(quadrant->data_position);
+        if (quadrant->overflow)
+        {
+            const vector<bucket_item_t>& overflow = *quadrant->overflow;
+            for (size_t i = 0; i < overflow.size(); i++)
+                points.push_back(overflow[i].position);
+        }
+    }
+}
 
 } // namespace epstl
@@ -0,0 +1,375 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "quadtree.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Exception stored in the result of a cancelled query
+ */
+class cancelled_exception : public exception
+{
+  public:
+    explicit cancelled_exception() noexcept = default;
+    explicit cancelled_exception(const char* what) noexcept :
+        exception(what) {}
+};
+
+/**
+ * @brief Result of an asynchronous query
+ *
+ * Wrap the future of the result with the cancellation flag of the query.
+ */
+template<typename result_t>
+class async_result
+{
+  public:
+    /**
+     * @brief Wait for the result and get it
+     *
+     * Throw epstl::cancelled_exception if the query was cancelled.
+     */
+    result_t get()
+    {
+        return m_future.get();
+    }
+
+    /**
+     * @brief Tells if the result is available, without blocking
+     */
+    bool ready() const
+    {
+        return m_future.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+    }
+
+    /**
+     * @brief Block until the result is available
+     */
+    void wait() const
+    {
+        m_future.wait();
+    }
+
+    /**
+     * @brief Cancel the query
+     *
+     * A query not started yet is skipped, a running query stops at the next
+     * quadrant.
+     */
+    void cancel() noexcept
+    {
+        m_cancelled->store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Identifier of the query, as given by quadtree_async::poll
+     */
+    uint64_t id() const noexcept
+    {
+        return m_id;
+    }
+
+  private:
+    template<typename, typename> friend class quadtree_async;
+
+    std::future<result_t> m_future;                 ///< Result of the query
+    std::shared_ptr<std::atomic<bool>> m_cancelled; ///< Cancellation flag
+    uint64_t m_id = 0;                              ///< Query identifier
+};
+
+/**
+ * @brief Run quadtree queries on a pool of worker threads
+ *
+ * The queries are queued and the workers take them by batches, so the lock
+ * of the tree is taken once for several queries. On demand, the identifiers
+ * of the finished queries are pushed in a completion queue, which can be
+ * polled from an event loop.
+ *
+ * The tree must only be modified through modify() while the object exists.
+ *
+ * Example :
+ * @code
+ * epstl::quadtree<float, int> tree(20, 20);
+ * epstl::quadtree_async<float, int> async_tree(tree, 0, 16, true);
+ *
+ * auto result = async_tree.query_range(-5, -5, 5, 5);
+ * // ...
+ * epstl::vector<uint64_t> done;
+ * async_tree.poll(done); // Identifiers of the finished queries
+ * auto keys = result.get();
+ * @endcode
+ */
+template<typename key_t, typename item_t>
+class quadtree_async
+{
+  public:
+    typedef vector<epstl::pair<key_t>> keys_t; ///< Result of the key queries
+
+    explicit quadtree_async(quadtree<key_t, item_t>& tree, size_t workers = 0,
+                            size_t batch_size = 16,
+                            bool track_completion = false);
+    quadtree_async(const quadtree_async& copy) = delete;
+    quadtree_async& operator=(const quadtree_async& copy) = delete;
+    ~quadtree_async();
+
+    async_result<keys_t> query_range(key_t left, key_t bottom, key_t right,
+                                     key_t top);
+    async_result<keys_t> nearest(key_t x, key_t y, size_t count);
+    async_result<item_t> at(key_t x, key_t y);
+
+    /**
+     * @brief Modify the tree, without concurrent queries
+     *
+     * Wait for the running batches to finish.
+     * @param function Function called with the tree
+     */
+    template<typename function_t>
+    void modify(function_t function)
+    {
+        std::unique_lock<std::shared_mutex> lock(m_tree_mutex);
+        function(m_tree);
+    }
+
+    size_t poll(vector<uint64_t>& completed);
+
+  private:
+    /**
+     * @brief Queued query
+     */
+    struct task_t
+    {
+        uint64_t id = 0;
+        std::shared_ptr<std::atomic<bool>> cancelled;
+        std::function<void(const std::atomic<bool>*)> run;
+    };
+
+    template<typename result_t, typename function_t>
+    async_result<result_t> submit(function_t function);
+    void work();
+
+    quadtree<key_t, item_t>& m_tree;    ///< Tree queried
+    size_t m_batch_size;                ///< Maximum number of queries by batch
+    bool m_track_completion;            ///< Fill the completion queue
+    std::shared_mutex m_tree_mutex;     ///< Queries share, modify excludes
+    std::mutex m_queue_mutex;           ///< Protects the queues
+    std::condition_variable m_queue_condition; ///< Signals new queries
+    // Standard queues for the FIFO pop_front, and a std::vector for the
+    // threads, which can not be copied: they are built in place by
+    // emplace_back, which epstl::vector does not provide
+    std::deque<task_t> m_queue;         ///< Queries waiting for a worker
+    std::deque<uint64_t> m_completed;   ///< Identifiers of finished queries
+    uint64_t m_next_id = 1;             ///< Identifier of the next query
+    bool m_stop = false;                ///< Stop the workers
+    std::vector<std::thread> m_workers; ///< Worker pool
+};
+
+/**
+ * @brief Start the worker pool
+ * @param tree Tree to query
+ * @param workers Number of threads, 0 for the hardware concurrency
+ * @param batch_size Maximum number of queries run under one lock
+ * @param track_completion Push the identifiers of the finished queries in
+ * the completion queue. Only enable it if poll() is called regularly: the
+ * queue grows until then.
+ */
+template<typename key_t, typename item_t>
+quadtree_async<key_t, item_t>::quadtree_async(quadtree<key_t, item_t>& tree,
+        size_t workers, size_t batch_size, bool track_completion) :
+    m_tree(tree), m_batch_size(batch_size ? batch_size : 1),
+    m_track_completion(track_completion)
+{
+    if (workers == 0)
+        workers = epstl::max(std::thread::hardware_concurrency(), 1u);
+    for (size_t i = 0; i < workers; i++)
+        m_workers.emplace_back(&quadtree_async::work, this);
+}
+
+/**
+ * @brief Stop the workers
+ *
+ * The queries not started yet are cancelled.
+ */
+template<typename key_t, typename item_t>
+quadtree_async<key_t, item_t>::~quadtree_async()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        m_stop = true;
+        for (task_t& task : m_queue)
+            task.cancelled->store(true, std::memory_order_relaxed);
+    }
+    m_queue_condition.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+/**
+ * @brief Queue a range query (see quadtree::query_range)
+ */
+template<typename key_t, typename item_t>
+async_result<typename quadtree_async<key_t, item_t>::keys_t>
+quadtree_async<key_t, item_t>::query_range(key_t left, key_t bottom,
+        key_t right, key_t top)
+{
+    return submit<keys_t>([this, left, bottom, right, top](
+                              const std::atomic<bool>* cancelled)
+    {
+        keys_t keys;
+        m_tree.query_range(left, bottom, right, top, keys, cancelled);
+        return keys;
+    });
+}
+
+/**
+ * @brief Queue a nearest neighbours query (see quadtree::nearest)
+ */
+template<typename key_t, typename item_t>
+async_result<typename quadtree_async<key_t, item_t>::keys_t>
+quadtree_async<key_t, item_t>::nearest(key_t x, key_t y, size_t count)
+{
+    return submit<keys_t>([this, x, y, count](const std::atomic<bool>*
+                          cancelled)
+    {
+        keys_t keys;
+        m_tree.nearest(x, y, count, keys, cancelled);
+        return keys;
+    });
+}
+
+/**
+ * @brief Queue a point query (see quadtree::at)
+ */
+template<typename key_t, typename item_t>
+async_result<item_t> quadtree_async<key_t, item_t>::at(key_t x, key_t y)
+{
+    return submit<item_t>([this, x, y](const std::atomic<bool>*)
+    {
+        const quadtree<key_t, item_t>& tree = m_tree;
+        return tree.at(x, y);
+    });
+}
+
+/**
+ * @brief Get the identifiers of the queries finished since the last call
+ *
+ * Do not block. Nothing is added if the completion is not tracked (see the
+ * constructor).
+ * @param[out] completed Identifiers of the finished queries, appended
+ * @return Return the number of identifiers added
+ */
+template<typename key_t, typename item_t>
+size_t quadtree_async<key_t, item_t>::poll(vector<uint64_t>& completed)
+{
+    std::lock_guard<std::mutex> lock(m_queue_mutex);
+    size_t count = m_completed.size();
+    for (uint64_t id : m_completed)
+        completed.push_back(id);
+    m_completed.clear();
+    return count;
+}
+
+/**
+ * @brief Queue the query
+ * @param function Query to run, called with the cancellation flag
+ * @return Return the result handle
+ */
+template<typename key_t, typename item_t>
+template<typename result_t, typename function_t>
+async_result<result_t> quadtree_async<key_t, item_t>::submit(
+    function_t function)
+{
+    auto promise = std::make_shared<std::promise<result_t>>();
+    async_result<result_t> result;
+    result.m_future = promise->get_future();
+    result.m_cancelled = std::make_shared<std::atomic<bool>>(false);
+
+    task_t task;
+    task.cancelled = result.m_cancelled;
+    task.run = [promise, function](const std::atomic<bool>* cancelled)
+    {
+        if (cancelled->load(std::memory_order_relaxed))
+        {
+            promise->set_exception(std::make_exception_ptr(
+                                       cancelled_exception("Query cancelled")));
+            return;
+        }
+        try
+        {
+            result_t value = function(cancelled);
+            // A query stopped in the middle has a partial result
+            if (cancelled->load(std::memory_order_relaxed))
+                promise->set_exception(std::make_exception_ptr(
+                                           cancelled_exception("Query cancelled")));
+            else
+                promise->set_value(std::move(value));
+        }
+        catch (...)
+        {
+            promise->set_exception(std::current_exception());
+        }
+    };
+
+    {
+        std::lock_guard<std::mutex> lock(m_queue_mutex);
+        task.id = m_next_id++;
+        result.m_id = task.id;
+        m_queue.push_back(std::move(task));
+    }
+    m_queue_condition.notify_one();
+    return result;
+}
+
+/**
+ * @brief Loop of the workers: take a batch of queries and run them
+ */
+template<typename key_t, typename item_t>
+void quadtree_async<key_t, item_t>::work()
+{
+    std::vector<task_t> batch;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_queue_mutex);
+            m_queue_condition.wait(lock, [this]()
+            {
+                return m_stop || !m_queue.empty();
+            });
+            if (m_queue.empty())
+                return;
+            while (!m_queue.empty() && batch.size() < m_batch_size)
+            {
+                batch.push_back(std::move(m_queue.front()));
+                m_queue.pop_front();
+            }
+        }
+        // Let another worker take the remaining queries
+        m_queue_condition.notify_one();
+
+        {
+            std::shared_lock<std::shared_mutex> lock(m_tree_mutex);
+            for (task_t& task : batch)
+                task.run(task.cancelled.get());
+        }
+
+        if (m_track_completion)
+        {
+            std::lock_guard<std::mutex> lock(m_queue_mutex);
+            for (task_t& task : batch)
+                m_completed.push_back(task.id);
+        }
+        batch.clear();
+    }
+}
+
+} // namespace epstl
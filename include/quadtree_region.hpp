@@ -1,47 +1,77 @@
 #pragma once
 
-#include "quadtree.hpp"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <type_traits>
+#include <unordered_map>
+
+#include "region_quadtree.hpp"
 #include "vector.hpp"
 
 namespace epstl
 {
 
 /**
- * @brief Point quadtree
- *
- * Create a quadtree structure with one point maximum by quadrant.
+ * @brief Binary region quadtree
  *
- * The item contained in the quadtree has to have a default value. By
- * default, the default value is the default constructor of the type.
- * If this value is set by the user, it will be invisible.
+ * Region quadtree of boolean cells (see region_quadtree), with the set
+ * operations, the morphology, the bitmaps and the queries on the free
+ * space. The size is the number of set cells.
  *
  * Example :
  * @code
- * // Create a quadtree with integers as keys and containing chars
  * // The size of the tree is 20 by 20, centered on zero.
- * epstl::quadtree<int, char> tree(20, 20);
- *
- * // Insert 'a' into the tree
- * epstl::size_t tree_size = tree.insert(5, 5, 'a');
- * // Get the value at 5,5
- * int value = tree.at(5, 5); // returns 'a'
+ * epstl::quadtree_region<int> tree(20, 20);
  *
- * tree_size = tree.insert(3, 3, 'b');
+ * tree.set(5, 5);
+ * tree.at(5, 5); // returns true
  *
- * epstl::pair<int> keys;
- * tree.find('c', keys); // Return false
- * tree.find('a', keys); // Return true. keys contains now 5,5
+ * // Polygon given as x0, y0, x1, y1, ...: set the 4 by 4 square
+ * tree.set_region({0, 0, 4, 0, 4, 4, 0, 4});
+ * tree.size(); // returns 17
  *
- * // Remove items
- * tree.remove_all(100); // remove 5,5
- * tree.remove(3, 3); // remove 110
+ * tree.unset_rect(0, 0, 2, 4); // Unset the left half of the square
  * @endcode
  */
 template<typename key_t = int>
-class quadtree_region : public quadtree<key_t, bool>
+class quadtree_region : public region_quadtree<key_t, bool>
 {
-    bool isIndide(const vector<key_t>& polygon, key_t x, key_t y) const;
+  protected:
+    typedef region_quadtree<key_t, bool> region_t;
+    typedef typename region_t::quadrant_t quadrant_t;
+    typedef typename region_t::rect_bound_t rect_bound_t;
+    typedef typename region_t::direction_t direction_t;
+
+    using region_t::direction_west;
+    using region_t::direction_east;
+    using region_t::direction_south;
+    using region_t::direction_north;
+    using region_t::create_root;
+    using region_t::root_bound;
+    using region_t::assign_quadrant;
+    using region_t::split_leaf;
+    using region_t::update_quadrant;
+    using region_t::neighbour_leaves;
+    using region_t::leaf_at;
+    using region_t::collect_leaves;
+    using region_t::area;
+    using region_t::isEmpty;
+
   public:
+    /**
+     * @brief Connected set of cells with the same state
+     */
+    struct component_t
+    {
+        size_t area = 0;    ///< Number of cells
+        key_t left = 0;     ///< Left of the bounding box
+        key_t bottom = 0;   ///< Bottom of the bounding box
+        key_t right = 0;    ///< Right of the bounding box (excluded)
+        key_t top = 0;      ///< Top of the bounding box (excluded)
+    };
+
     /**
      * @brief Construct a quadtree with the given center and width/height
      * @param center_x X coordinate of the center
@@ -51,7 +81,7 @@ class quadtree_region : public quadtree<key_t, bool>
      */
     explicit quadtree_region(key_t center_x, key_t center_y, key_t width,
                              key_t height) :
-        quadtree<key_t, bool>(center_x, center_y, width, height, false) {}
+        region_t(center_x, center_y, width, height) {}
 
     /**
      * @brief Construct a quadtree centered on 0,0, with the given width/height
@@ -59,7 +89,7 @@ class quadtree_region : public quadtree<key_t, bool>
      * @param height Height of the root
      */
     explicit quadtree_region(key_t width, key_t height) :
-        quadtree<key_t, bool>(0, 0, width, height) {}
+        region_t(width, height) {}
 
     /**
      * @brief Construct a quadtree with the given center and width/height and the default value
@@ -72,102 +102,523 @@ class quadtree_region : public quadtree<key_t, bool>
     explicit quadtree_region(key_t center_x, key_t center_y, key_t width,
                              key_t height,
                              bool default_value) :
-        quadtree<key_t, bool>(center_x, center_y, width, height, default_value) {}
+        region_t(center_x, center_y, width, height, default_value) {}
 
     explicit quadtree_region(const quadtree_region& copy)  :
-        quadtree<key_t, bool> (copy) {}
+        region_t(copy) {}
 
     explicit quadtree_region(quadtree_region&& move) :
-        quadtree<key_t, bool> (move) {}
+        region_t(std::move(move)) {}
     ~quadtree_region() override = default;
 
     quadtree_region& operator=(const quadtree_region& copy)
     {
-        return quadtree<key_t, bool>::operator=(copy);
-    };
+        region_t::operator=(copy);
+        return *this;
+    }
     quadtree_region& operator=(quadtree_region&& move)
     {
-        return quadtree<key_t, bool>::operator=(move);
+        region_t::operator=(std::move(move));
+        return *this;
     }
 
-    size_t insert(key_t x, key_t y, const bool& item) override;
-    size_t insert_region(const vector<key_t>& polygon_points, const bool& item);
-
     void set(key_t x, key_t y)
     {
-        insert(x, y, true);
+        this->insert(x, y, true);
     }
     void unset(key_t x, key_t y)
     {
-        insert(x, y, false);
+        this->insert(x, y, false);
     }
 
     void set_region(const vector<key_t>& polygon_points)
     {
-        insert_region(polygon_points, true);
+        this->insert_region(polygon_points, true);
     }
     void unset_region(const vector<key_t>& polygon_points)
     {
-        insert_region(polygon_points, false);
+        this->insert_region(polygon_points, false);
+    }
+
+    /**
+     * @brief Set the cells of the rectangle [left, right[ * [bottom, top[
+     */
+    void set_rect(key_t left, key_t bottom, key_t right, key_t top)
+    {
+        this->insert_rect(left, bottom, right, top, true);
+    }
+    /**
+     * @brief Unset the cells of the rectangle [left, right[ * [bottom, top[
+     */
+    void unset_rect(key_t left, key_t bottom, key_t right, key_t top)
+    {
+        this->insert_rect(left, bottom, right, top, false);
+    }
+
+    size_t combine(const quadtree_region& other,
+                   std::function<bool(bool, bool)> operation);
+
+    /**
+     * @brief Set the cells not farther than the radius from a set cell
+     *
+     * The distance is measured between the cell coordinates. Only for
+     * integral keys.
+     * @param radius Radius of the disk
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t dilate(key_t radius)
+    {
+        return spread(radius, true);
+    }
+
+    /**
+     * @brief Unset the cells not farther than the radius from an unset cell
+     *
+     * The cells outside of the tree are ignored. Only for integral keys.
+     * @param radius Radius of the disk
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t erode(key_t radius)
+    {
+        return spread(radius, false);
+    }
+
+    /**
+     * @brief Set the cells set in the other region
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t union_with(const quadtree_region& other)
+    {
+        return combine(other, [](bool a, bool b)
+        {
+            return a || b;
+        });
+    }
+
+    /**
+     * @brief Keep only the cells also set in the other region
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t intersect_with(const quadtree_region& other)
+    {
+        return combine(other, [](bool a, bool b)
+        {
+            return a && b;
+        });
+    }
+
+    /**
+     * @brief Unset the cells set in the other region
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t subtract(const quadtree_region& other)
+    {
+        return combine(other, [](bool a, bool b)
+        {
+            return a && !b;
+        });
+    }
+
+    /**
+     * @brief Keep the cells set in only one of the regions
+     * @return Size of the new tree (number of set cells)
+     */
+    size_t xor_with(const quadtree_region& other)
+    {
+        return combine(other, [](bool a, bool b)
+        {
+            return a != b;
+        });
+    }
+
+    quadtree_region& operator|=(const quadtree_region& other)
+    {
+        union_with(other);
+        return *this;
+    }
+    quadtree_region& operator&=(const quadtree_region& other)
+    {
+        intersect_with(other);
+        return *this;
+    }
+    quadtree_region& operator-=(const quadtree_region& other)
+    {
+        subtract(other);
+        return *this;
+    }
+    quadtree_region& operator^=(const quadtree_region& other)
+    {
+        xor_with(other);
+        return *this;
     }
 
+    /**
+     * @brief Number of 64 bits words by row of the bitmaps
+     */
+    size_t bitmap_stride() const noexcept
+    {
+        return (static_cast<size_t>(this->m_width) + 63) / 64;
+    }
+
+    size_t from_bitmap(const uint64_t* bitmap);
+    void to_bitmap(uint64_t* bitmap) const;
+
     void print(std::ostream& stream) const override;
 
+    size_t connected_components(vector<component_t>& components,
+                                bool item = true, bool eight_connected = false) const;
+
+    bool find_path(key_t start_x, key_t start_y, key_t goal_x, key_t goal_y,
+                   vector<epstl::pair<double>>& path) const;
+
+    bool raycast(double origin_x, double origin_y, double direction_x,
+                 double direction_y, double max_range, double& distance) const;
+    size_t raycast_fan(double origin_x, double origin_y, double first_angle,
+                       double angle_step, size_t count, double max_range,
+                       double* distances) const;
+    bool line_of_sight(key_t from_x, key_t from_y, key_t to_x, key_t to_y) const;
+
+    bool nearest_set(key_t x, key_t y, key_t& nearest_x, key_t& nearest_y,
+                     double max_distance =
+                         std::numeric_limits<double>::infinity()) const;
+
   protected:
-    bool insert_quadrant(typename quadtree<key_t, bool>::quadrant_t* quadrant,
-                         key_t x, key_t y,
-                         const bool& item) override;
-    const bool& get_value(typename quadtree<key_t, bool>::quadrant_t* quadrant,
-                          key_t x, key_t y) const override;
-    bool& get_value(typename quadtree<key_t, bool>::quadrant_t* quadrant, key_t x,
-                    key_t y) override;
+    /**
+     * @brief Ray with a normalized direction
+     */
+    struct ray_t
+    {
+        double origin_x;
+        double origin_y;
+        double direction_x;
+        double direction_y;
+        double range;       ///< Length of the ray
+    };
+
+    void combine_quadrant(quadrant_t* quadrant, const quadrant_t* other_quadrant,
+                          bool other_value,
+                          const std::function<bool(bool, bool)>& operation);
+    void invert_quadrant(quadrant_t* quadrant);
+    size_t spread(key_t radius, bool item);
+    void border_leaves(const quadrant_t* quadrant, bool item,
+                       vector<rect_bound_t>& leaves) const;
+    void build_quadrant(quadrant_t* quadrant, const uint64_t* bitmap);
+    void export_quadrant(const quadrant_t* quadrant, uint64_t* bitmap) const;
+    uint8_t bitmap_state(const uint64_t* bitmap, const rect_bound_t& bound) const;
+    static double cell_center(key_t coordinate);
+    static epstl::pair<double> portal(const rect_bound_t& from,
+                                      const rect_bound_t& to);
+    static double distance(const epstl::pair<double>& a,
+                           const epstl::pair<double>& b);
+    bool cast_quadrant(const quadrant_t* quadrant, const ray_t& ray,
+                       double& distance) const;
+    static bool ray_interval(const rect_bound_t& bound, const ray_t& ray,
+                             double& enter);
+    static bool ray_slab(double low, double high, double origin,
+                         double direction, double& enter, double& exit);
+    static size_t find_set(vector<size_t>& parents, size_t index);
+    static double nearest_cell(const rect_bound_t& bound, key_t x, key_t y,
+                               key_t& nearest_x, key_t& nearest_y);
 };
 
 /**
- * @brief Insert the item at the given coordinates
+ * @brief Give the state to the cells not farther than the radius from a
+ * cell with this state
  *
- * Update the depth.
+ * The closest cell with the state to a cell without it is always on the
+ * border of the state, so only the leaves touching a cell with the other
+ * state are spread. Each of them gives its state to its bounds grown by a
+ * disk, set by horizontal bands.
  *
- * @param x X coordinate of the item
- * @param y Y coordinate of the item
- * @param item Item to copy in the tree
- * @return Size of the new tree (number of items)
+ * @param radius Radius of the disk
+ * @param item State to spread
+ * @return Size of the new tree (number of set cells)
  */
 template<typename key_t>
-size_t quadtree_region<key_t>::insert(key_t x, key_t y, const bool& item)
+size_t quadtree_region<key_t>::spread(key_t radius, bool item)
+{
+    static_assert(std::is_integral<key_t>::value,
+                  "The morphological operations need integral keys");
+    if (!this->m_root || radius <= 0)
+        return this->m_size;
+
+    vector<rect_bound_t> leaves;
+    border_leaves(this->m_root, item, leaves);
+
+    double squared_radius = static_cast<double>(radius) * radius;
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        const rect_bound_t& leaf = leaves[i];
+        this->insert_rect(leaf.left - radius, leaf.bottom, leaf.right + radius,
+                          leaf.top, item);
+        key_t band_start = 1;
+        while (band_start <= radius)
+        {
+            // Rows at the same distance of the leaf have the same half width
+            key_t half_width = static_cast<key_t>(std::floor(std::sqrt(
+                    squared_radius - static_cast<double>(band_start) * band_start)));
+            key_t band_end = band_start + 1;
+            while (band_end <= radius &&
+                    static_cast<key_t>(std::floor(std::sqrt(squared_radius -
+                                       static_cast<double>(band_end) * band_end))) == half_width)
+                band_end++;
+            this->insert_rect(leaf.left - half_width, leaf.top - 1 + band_start,
+                              leaf.right + half_width, leaf.top - 1 + band_end, item);
+            this->insert_rect(leaf.left - half_width, leaf.bottom - band_end + 1,
+                              leaf.right + half_width, leaf.bottom - band_start + 1, item);
+            band_start = band_end;
+        }
+    }
+    return this->m_size;
+}
+
+/**
+ * @brief List the leaves with the state which touch a cell without it
+ *
+ * The cells along the four sides of the leaves are counted with count_set.
+ * @param quadrant Quadrant to look into
+ * @param item State of the leaves
+ * @param[out] leaves Bounds of the leaves found
+ */
+template<typename key_t>
+void quadtree_region<key_t>::border_leaves(const quadrant_t* quadrant,
+        bool item, vector<rect_bound_t>& leaves) const
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound))
+        return;
+    if (!quadrant->isLeaf())
+    {
+        for (const quadrant_t* child : quadrant->children)
+            border_leaves(child, item, leaves);
+        return;
+    }
+    if (quadrant->data != item)
+        return;
+
+    const rect_bound_t& root = this->m_root->bound;
+    rect_bound_t sides[4] = {bound, bound, bound, bound};
+    sides[0].right = bound.left;
+    sides[0].left = bound.left - 1;
+    sides[1].left = bound.right;
+    sides[1].right = bound.right + 1;
+    sides[2].top = bound.bottom;
+    sides[2].bottom = bound.bottom - 1;
+    sides[3].bottom = bound.top;
+    sides[3].top = bound.top + 1;
+    for (rect_bound_t& side : sides)
+    {
+        // The cells outside of the tree are ignored
+        side.left = epstl::max(side.left, root.left);
+        side.right = epstl::min(side.right, root.right);
+        side.bottom = epstl::max(side.bottom, root.bottom);
+        side.top = epstl::min(side.top, root.top);
+        if (isEmpty(side))
+            continue;
+        size_t count = this->count_set(side.left, side.bottom, side.right, side.top);
+        if (item ? count < area(side) : count > 0)
+        {
+            leaves.push_back(bound);
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Label the connected sets of cells with the given state
+ *
+ * The labeling works on the leaves: the adjacent leaves are found with the
+ * neighbour finding through the parents, and joined with a union-find. The
+ * work depends on the number of leaves, not on the number of cells.
+ *
+ * @param[out] components Components found, appended
+ * @param item State of the cells to label
+ * @param eight_connected Also join the cells touching by a corner
+ * @return Return the number of components found
+ */
+template<typename key_t>
+size_t quadtree_region<key_t>::connected_components(vector<component_t>&
+        components, bool item, bool eight_connected) const
 {
     if (!this->m_root)
     {
-        this->m_root = new typename quadtree<key_t, bool>::quadrant_t;
-        this->m_root->bound.left = this->m_center.x - this->m_width / 2.;
-        this->m_root->bound.right = this->m_root->bound.left + this->m_width;
-        this->m_root->bound.bottom = this->m_center.y - this->m_height / 2.;
-        this->m_root->bound.top = this->m_root->bound.bottom + this->m_height;
-        this->m_root->bound.center = this->m_center;
-        this->m_root->data = this->m_default_value;
+        // Untouched tree: all the cells have the default state
+        rect_bound_t bound = root_bound();
+        if (item != this->m_default_value || isEmpty(bound))
+            return 0;
+        component_t component;
+        component.area = area(bound);
+        component.left = bound.left;
+        component.bottom = bound.bottom;
+        component.right = bound.right;
+        component.top = bound.top;
+        components.push_back(component);
+        return 1;
+    }
+    vector<const quadrant_t*> leaves;
+    collect_leaves(this->m_root, item, leaves);
+    // Index of each leaf, looked up for every adjacency: epstl has no hash map
+    std::unordered_map<const quadrant_t*, size_t> indexes;
+    vector<size_t> parents;
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        indexes[leaves[i]] = i;
+        parents.push_back(i);
+    }
+
+    // Each adjacency is found from its west or south leaf
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        const quadrant_t* leaf = leaves[i];
+        vector<const quadrant_t*> neighbours;
+        neighbour_leaves(leaf, direction_east, neighbours);
+        neighbour_leaves(leaf, direction_north, neighbours);
+        if (eight_connected)
+        {
+            const rect_bound_t& bound = leaf->bound;
+            if (const quadrant_t* corner = leaf_at(bound.right, bound.top))
+                neighbours.push_back(corner);
+            if (const quadrant_t* corner = leaf_at(bound.left - 1, bound.top))
+                neighbours.push_back(corner);
+        }
+        for (size_t j = 0; j < neighbours.size(); j++)
+        {
+            if (neighbours[j]->data != item)
+                continue;
+            size_t root = find_set(parents, i);
+            size_t other_root = find_set(parents, indexes[neighbours[j]]);
+            if (root != other_root)
+                parents[epstl::max(root, other_root)] = epstl::min(root, other_root);
+        }
     }
-    insert_quadrant(this->m_root, x, y, item);
-    this->m_depth = this->compute_depth(this->m_root);
 
+    // The root of a set is its first leaf: the components are in leaf order
+    size_t first = components.size();
+    vector<size_t> labels;
+    for (size_t i = 0; i < leaves.size(); i++)
+    {
+        size_t root = find_set(parents, i);
+        const rect_bound_t& bound = leaves[i]->bound;
+        if (root == i)
+        {
+            labels.push_back(components.size());
+            component_t component;
+            component.left = bound.left;
+            component.bottom = bound.bottom;
+            component.right = bound.right;
+            component.top = bound.top;
+            components.push_back(component);
+        }
+        else
+        {
+            labels.push_back(labels[root]);
+        }
+        component_t& component = components[labels[i]];
+        component.area += area(bound);
+        component.left = epstl::min(component.left, bound.left);
+        component.bottom = epstl::min(component.bottom, bound.bottom);
+        component.right = epstl::max(component.right, bound.right);
+        component.top = epstl::max(component.top, bound.top);
+    }
+    return components.size() - first;
+}
+
+/**
+ * @brief Combine the other region into this one, cell by cell
+ *
+ * Both trees are traversed together. When one of the quadrants is uniform,
+ * the result is decided at once (constant, copy or inversion of the other
+ * side), and equal siblings are merged on the way back.
+ *
+ * @param other Region with the same center and dimensions
+ * @param operation New state of a cell from its state in this region and
+ * in the other one
+ * @return Size of the new tree (number of set cells)
+ */
+template<typename key_t>
+size_t quadtree_region<key_t>::combine(const quadtree_region& other,
+                                       std::function<bool(bool, bool)> operation)
+{
+    if (this->m_center.x != other.m_center.x ||
+            this->m_center.y != other.m_center.y ||
+            this->m_width != other.m_width || this->m_height != other.m_height)
+        throw epstl::value_exception("The regions need to have the same bounds");
+    if (&other == this)
+    {
+        quadtree_region copy(other);
+        return combine(copy, operation);
+    }
+
+    create_root();
+    combine_quadrant(this->m_root, other.m_root, other.m_default_value,
+                     operation);
     return this->m_size;
 }
 
+/**
+ * @brief Recursive method for combine
+ *
+ * @param quadrant Quadrant of this region
+ * @param other_quadrant Quadrant of the other region with the same bounds,
+ * null if the other region is uniform
+ * @param other_value State of the other region when other_quadrant is null
+ * @param operation Operation to apply on each cell
+ */
 template<typename key_t>
-size_t quadtree_region<key_t>::insert_region(const vector<key_t>&
-        polygon_points, const bool& item)
+void quadtree_region<key_t>::combine_quadrant(quadrant_t* quadrant,
+        const quadrant_t* other_quadrant, bool other_value,
+        const std::function<bool(bool, bool)>& operation)
 {
-    if (!this->m_root)
+    if (isEmpty(quadrant->bound))
+        return;
+    if (!other_quadrant || other_quadrant->isLeaf())
+    {
+        // Uniform other side: the operation is a function of this side only
+        bool value = other_quadrant ? other_quadrant->data : other_value;
+        bool if_unset = operation(false, value);
+        bool if_set = operation(true, value);
+        if (if_unset == if_set)
+            assign_quadrant(quadrant, if_set);
+        else if (if_unset)
+            invert_quadrant(quadrant);
+        return;
+    }
+
+    if (quadrant->isLeaf())
     {
-        this->m_root = new typename quadtree<key_t, bool>::quadrant_t;
-        this->m_root->bound.left = this->m_center.x - this->m_width / 2.;
-        this->m_root->bound.right = this->m_root->bound.left + this->m_width;
-        this->m_root->bound.bottom = this->m_center.y - this->m_height / 2.;
-        this->m_root->bound.top = this->m_root->bound.bottom + this->m_height;
-        this->m_root->bound.center = this->m_center;
-        this->m_root->data = this->m_default_value;
+        // Uniform side: the result does not depend on the other side
+        bool if_unset = operation(quadrant->data, false);
+        if (if_unset == operation(quadrant->data, true))
+        {
+            assign_quadrant(quadrant, if_unset);
+            return;
+        }
+        split_leaf(quadrant);
     }
-    return this->size();
+    for (uint8_t i = 0; i < 4; i++)
+        combine_quadrant(quadrant->children[i], other_quadrant->children[i],
+                         other_value, operation);
+    update_quadrant(quadrant);
+}
 
+/**
+ * @brief Invert the state of all the cells of the quadrant
+ *
+ * The division does not change, so no merge is needed.
+ * @param quadrant Quadrant to invert
+ */
+template<typename key_t>
+void quadtree_region<key_t>::invert_quadrant(quadrant_t* quadrant)
+{
+    if (quadrant->isLeaf())
+    {
+        assign_quadrant(quadrant, !quadrant->data);
+        return;
+    }
+    for (quadrant_t* child : quadrant->children)
+        invert_quadrant(child);
+    quadrant->count = area(quadrant->bound) - quadrant->count;
+    quadrant->epoch = this->m_epoch;
 }
 
 template<typename key_t>
@@ -179,165 +630,636 @@ void quadtree_region<key_t>::print(std::ostream& stream) const
         return;
     }
     stream << "Tree:\n";
-    for (key_t row = this->m_root->bound.top; row > this->m_root->bound.bottom;
-            row--)
+    if constexpr (std::is_integral<key_t>::value)
+    {
+        size_t stride = bitmap_stride();
+        size_t height = static_cast<size_t>(this->m_height);
+        uint64_t* bitmap = new uint64_t[stride * height];
+        to_bitmap(bitmap);
+        for (size_t row = height; row-- > 0;)
+        {
+            const uint64_t* words = bitmap + row * stride;
+            for (size_t col = 0; col < static_cast<size_t>(this->m_width); col++)
+                stream << ((words[col / 64] >> (col % 64)) & 1 ? '1' : '0') << " ";
+            stream << "\n";
+        }
+        delete[] bitmap;
+    }
+    else
     {
-        for (key_t col = this->m_root->bound.left; col < this->m_root->bound.right;
-                col++)
+        for (key_t row = this->m_root->bound.top; row > this->m_root->bound.bottom;
+                row--)
         {
-            bool state = this->at(col, row);
-            stream << (state ? '1' : '0') << " ";
+            for (key_t col = this->m_root->bound.left; col < this->m_root->bound.right;
+                    col++)
+            {
+                bool state = this->at(col, row);
+                stream << (state ? '1' : '0') << " ";
+            }
+            stream << "\n";
         }
-        stream << "\n";
     }
 }
 
 /**
- * @brief Insert the item on the quadrant at the given coordinates
+ * @brief Replace the content of the tree by the packed bitmap
  *
- * @param quadrant Quadrant to use (for recursive use)
- * @param x X coordinate of the item to insert
- * @param y Y coordinate of the item to insert
- * @param item Item to copy into the tree
+ * The bitmap has one bit by cell, the least significant bit first. Each row
+ * takes bitmap_stride() words, the first row is the bottom of the tree. The
+ * tree is built bottom-up: the quadrants up to 64 cells wide are tested
+ * word by word and stay leaves when they are uniform, the larger ones are
+ * merged from their children.
+ *
+ * Only for integral keys.
+ * @param bitmap Bitmap of width * height cells
+ * @return Size of the new tree (number of set cells)
  */
 template<typename key_t>
-bool quadtree_region<key_t>::insert_quadrant(typename
-        quadtree<key_t, bool>::quadrant_t* quadrant, key_t x,
-        key_t y, const bool& item)
+size_t quadtree_region<key_t>::from_bitmap(const uint64_t* bitmap)
 {
-    if (!quadrant)
-        throw epstl::implementation_exception("insertion in a null quadrant");
-    if (!quadrant->bound.isInside(x, y))
-        return false;
-    if (quadrant->ne) // If there is a quadrant division
-    {
-        uint8_t modified_quadrants =
-            insert_quadrant(quadrant->ne, x, y, item)
-            + insert_quadrant(quadrant->nw, x, y, item)
-            + insert_quadrant(quadrant->sw, x, y, item)
-            + insert_quadrant(quadrant->se, x, y, item);
-        if (modified_quadrants > 0)
+    static_assert(std::is_integral<key_t>::value,
+                  "The bitmaps need integral keys");
+    this->reset();
+    create_root();
+    assign_quadrant(this->m_root, false);
+    build_quadrant(this->m_root, bitmap);
+    return this->m_size;
+}
+
+/**
+ * @brief Write the tree in a packed bitmap
+ *
+ * Same layout as from_bitmap. The set leaves are written by spans of words.
+ *
+ * Only for integral keys.
+ * @param[out] bitmap Bitmap of bitmap_stride() * height words
+ */
+template<typename key_t>
+void quadtree_region<key_t>::to_bitmap(uint64_t* bitmap) const
+{
+    static_assert(std::is_integral<key_t>::value,
+                  "The bitmaps need integral keys");
+    std::memset(bitmap, 0, bitmap_stride() * static_cast<size_t>(this->m_height) *
+                sizeof(uint64_t));
+    if (this->m_root)
+        export_quadrant(this->m_root, bitmap);
+}
+
+/**
+ * @brief Recursive method for from_bitmap
+ * @param quadrant Empty leaf to build
+ * @param bitmap Bitmap to import
+ */
+template<typename key_t>
+void quadtree_region<key_t>::build_quadrant(quadrant_t* quadrant,
+        const uint64_t* bitmap)
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound))
+        return;
+    if (bound.right - bound.left <= 64 || !this->can_split(quadrant))
+    {
+        uint8_t state = bitmap_state(bitmap, bound);
+        if (state != 2 || !this->can_split(quadrant))
         {
-            // If all quadrants are the same
-            if (this->compute_depth(quadrant) == 1 &&
-                    quadrant->ne->data == quadrant->nw->data &&
-                    quadrant->ne->data == quadrant->sw->data &&
-                    quadrant->ne->data == quadrant->se->data)
+            // A leaf which can not be divided follows its center cell
+            if (state == 2)
             {
-                quadrant->data = quadrant->ne->data;
-                this->free_quadrant(quadrant->ne);
-                this->free_quadrant(quadrant->nw);
-                this->free_quadrant(quadrant->sw);
-                this->free_quadrant(quadrant->se);
-                quadrant->ne = nullptr;
-                quadrant->nw = nullptr;
-                quadrant->sw = nullptr;
-                quadrant->se = nullptr;
-                return  true;
+                rect_bound_t cell;
+                cell.left = bound.center.x;
+                cell.right = cell.left + 1;
+                cell.bottom = bound.center.y;
+                cell.top = cell.bottom + 1;
+                state = bitmap_state(bitmap, cell);
             }
+            assign_quadrant(quadrant, state == 1);
+            return;
         }
-        return false;
     }
+    split_leaf(quadrant);
+    for (quadrant_t* child : quadrant->children)
+        build_quadrant(child, bitmap);
+    update_quadrant(quadrant);
+}
 
-    if (quadrant->data != item)
+/**
+ * @brief Tells if the cells of the bitmap inside the bounds are uniform
+ *
+ * Each row is tested by words.
+ * @param bitmap Bitmap to test
+ * @param bound Bounds of the cells to test
+ * @return 0 if all the cells are unset, 1 if they are all set, 2 else
+ */
+template<typename key_t>
+uint8_t quadtree_region<key_t>::bitmap_state(const uint64_t* bitmap,
+        const rect_bound_t& bound) const
+{
+    size_t stride = bitmap_stride();
+    size_t first = static_cast<size_t>(bound.left - this->m_root->bound.left);
+    size_t last = static_cast<size_t>(bound.right - this->m_root->bound.left) - 1;
+    size_t first_row = static_cast<size_t>(bound.bottom -
+                                           this->m_root->bound.bottom);
+    size_t end_row = static_cast<size_t>(bound.top - this->m_root->bound.bottom);
+    bool any = false;
+    bool all = true;
+    for (size_t row = first_row; row < end_row; row++)
     {
-        if ((quadrant->bound.left != quadrant->bound.center.x &&
-                quadrant->bound.right != quadrant->bound.center.x) ||
-                (quadrant->bound.bottom != quadrant->bound.center.y &&
-                 quadrant->bound.top != quadrant->bound.center.y))
+        const uint64_t* words = bitmap + row * stride;
+        for (size_t word = first / 64; word <= last / 64; word++)
         {
-            // Division
-            this->create_quadrants(quadrant);
-
-            insert_quadrant(quadrant->ne, quadrant->ne->bound.center.x,
-                            quadrant->ne->bound.center.y, quadrant->data);
-            insert_quadrant(quadrant->nw, quadrant->nw->bound.center.x,
-                            quadrant->nw->bound.center.y, quadrant->data);
-            insert_quadrant(quadrant->sw, quadrant->sw->bound.center.x,
-                            quadrant->sw->bound.center.y, quadrant->data);
-            insert_quadrant(quadrant->se, quadrant->se->bound.center.x,
-                            quadrant->se->bound.center.y, quadrant->data);
-
-            insert_quadrant(quadrant->ne, x, y, item);
-            insert_quadrant(quadrant->nw, x, y, item);
-            insert_quadrant(quadrant->sw, x, y, item);
-            insert_quadrant(quadrant->se, x, y, item);
-            return false;
+            uint64_t mask = ~0ULL;
+            if (word == first / 64)
+                mask &= ~0ULL << (first % 64);
+            if (word == last / 64)
+                mask &= ~0ULL >> (63 - last % 64);
+            uint64_t bits = words[word] & mask;
+            any |= bits != 0;
+            all &= bits == mask;
         }
-        else
+        if (any && !all)
+            return 2;
+    }
+    return all ? 1 : 0;
+}
+
+/**
+ * @brief Recursive method for to_bitmap
+ * @param quadrant Quadrant to write
+ * @param[out] bitmap Bitmap to fill
+ */
+template<typename key_t>
+void quadtree_region<key_t>::export_quadrant(const quadrant_t* quadrant,
+        uint64_t* bitmap) const
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound))
+        return;
+    if (!quadrant->isLeaf())
+    {
+        for (const quadrant_t* child : quadrant->children)
+            export_quadrant(child, bitmap);
+        return;
+    }
+    if (!quadrant->data)
+        return;
+
+    size_t stride = bitmap_stride();
+    size_t first = static_cast<size_t>(bound.left - this->m_root->bound.left);
+    size_t last = static_cast<size_t>(bound.right - this->m_root->bound.left) - 1;
+    size_t first_row = static_cast<size_t>(bound.bottom -
+                                           this->m_root->bound.bottom);
+    size_t end_row = static_cast<size_t>(bound.top - this->m_root->bound.bottom);
+    size_t first_word = first / 64;
+    size_t last_word = last / 64;
+    uint64_t first_mask = ~0ULL << (first % 64);
+    uint64_t last_mask = ~0ULL >> (63 - last % 64);
+    for (size_t row = first_row; row < end_row; row++)
+    {
+        uint64_t* words = bitmap + row * stride;
+        if (first_word == last_word)
         {
-            if (item)
-                this->m_size++;
-            else
-                this->m_size--;
-            quadrant->data = item;
-            return true;
+            words[first_word] |= first_mask & last_mask;
+            continue;
         }
+        words[first_word] |= first_mask;
+        if (last_word > first_word + 1)
+            std::memset(words + first_word + 1, 0xff,
+                        (last_word - first_word - 1) * sizeof(uint64_t));
+        words[last_word] |= last_mask;
     }
+}
 
-    return false;
+/**
+ * @brief Find a path between two free cells
+ *
+ * A* search on the free leaves: each leaf is a node, the neighbours are
+ * found through the parents. A large free area is crossed in one step
+ * instead of cell by cell. The path goes through the centers of the leaves
+ * and the middles of their common sides, so it stays in the free cells.
+ *
+ * @param start_x X coordinate of the start cell
+ * @param start_y Y coordinate of the start cell
+ * @param goal_x X coordinate of the goal cell
+ * @param goal_y Y coordinate of the goal cell
+ * @param[out] path Points of the path from the start to the goal, appended
+ * @return Return true if a path was found
+ */
+template<typename key_t>
+bool quadtree_region<key_t>::find_path(key_t start_x, key_t start_y,
+                                       key_t goal_x, key_t goal_y, vector<epstl::pair<double>>& path) const
+{
+    epstl::pair<double> start(cell_center(start_x), cell_center(start_y));
+    epstl::pair<double> goal(cell_center(goal_x), cell_center(goal_y));
+    if (!this->m_root)
+    {
+        // Untouched tree: a single leaf with the default state
+        rect_bound_t bound = root_bound();
+        if (this->m_default_value || !bound.isInside(start_x, start_y) ||
+                !bound.isInside(goal_x, goal_y))
+            return false;
+        path.push_back(start);
+        path.push_back(goal);
+        return true;
+    }
+    const quadrant_t* start_leaf = leaf_at(start_x, start_y);
+    const quadrant_t* goal_leaf = leaf_at(goal_x, goal_y);
+    if (!start_leaf || !goal_leaf || start_leaf->data || goal_leaf->data)
+        return false;
+    if (start_leaf == goal_leaf)
+    {
+        path.push_back(start);
+        path.push_back(goal);
+        return true;
+    }
+
+    struct node_t
+    {
+        double cost;                    ///< Length of the best path found
+        epstl::pair<double> position;   ///< Point of the path in the leaf
+        const quadrant_t* previous;     ///< Previous leaf of the path
+        bool closed;                    ///< Best path known
+    };
+    // Standard heap and hash map, which epstl does not provide
+    typedef std::pair<double, const quadrant_t*> entry_t;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>
+            open;
+    std::unordered_map<const quadrant_t*, node_t> nodes;
+    nodes[start_leaf] = node_t{0, start, nullptr, false};
+    open.push(entry_t(distance(start, goal), start_leaf));
+
+    while (!open.empty())
+    {
+        const quadrant_t* leaf = open.top().second;
+        open.pop();
+        node_t& node = nodes[leaf];
+        if (node.closed)
+            continue;
+        node.closed = true;
+        if (leaf == goal_leaf)
+            break;
 
+        vector<const quadrant_t*> neighbours;
+        for (uint8_t direction = direction_west; direction <= direction_north;
+                direction++)
+            neighbour_leaves(leaf, static_cast<direction_t>(direction), neighbours);
+        for (size_t i = 0; i < neighbours.size(); i++)
+        {
+            const quadrant_t* neighbour = neighbours[i];
+            if (neighbour->data)
+                continue;
+            const rect_bound_t& bound = neighbour->bound;
+            epstl::pair<double> position = neighbour == goal_leaf ? goal :
+                                           epstl::pair<double>((bound.left + bound.right) / 2.,
+                                                   (bound.bottom + bound.top) / 2.);
+            epstl::pair<double> middle = portal(leaf->bound, bound);
+            double cost = node.cost + distance(node.position, middle) +
+                          distance(middle, position);
+            auto found = nodes.find(neighbour);
+            if (found != nodes.end() && (found->second.closed ||
+                                         found->second.cost <= cost))
+                continue;
+            nodes[neighbour] = node_t{cost, position, leaf, false};
+            open.push(entry_t(cost + distance(position, goal), neighbour));
+        }
+    }
+
+    if (!nodes[goal_leaf].closed)
+        return false;
+    // Walk back from the goal, then reverse the added points
+    size_t first = path.size();
+    for (const quadrant_t* leaf = goal_leaf; leaf;)
+    {
+        const node_t& node = nodes[leaf];
+        path.push_back(node.position);
+        if (node.previous)
+            path.push_back(portal(node.previous->bound, leaf->bound));
+        leaf = node.previous;
+    }
+    for (size_t i = first, j = path.size() - 1; i < j; i++, j--)
+    {
+        epstl::pair<double> point = path[i];
+        path[i] = path[j];
+        path[j] = point;
+    }
+    return true;
 }
 
 /**
- * @brief Get the value at the given position
+ * @brief Find the first set cell along a ray
  *
- * Return the default value if there is nothing at the given coordinates
- * @param quadrant Quadrant to look into
- * @param x X coordinate to look for
- * @param y Y coordinate to look for
- * @return Constant reference on the value
+ * The quadrants crossed by the ray are visited front to back, a leaf is
+ * crossed in one step whatever its size. A ray touching a corner of a cell
+ * does not cross it.
+ *
+ * @param origin_x X coordinate of the origin
+ * @param origin_y Y coordinate of the origin
+ * @param direction_x X component of the direction
+ * @param direction_y Y component of the direction
+ * @param max_range Length of the ray
+ * @param[out] distance Distance to the first set cell, max_range if none
+ * @return Return true if a set cell was hit
  */
 template<typename key_t>
-const bool& quadtree_region<key_t>::get_value(typename
-        quadtree<key_t, bool>::quadrant_t* quadrant, key_t x,
-        key_t y) const
+bool quadtree_region<key_t>::raycast(double origin_x, double origin_y,
+                                     double direction_x, double direction_y, double max_range,
+                                     double& distance) const
 {
-    if (!quadrant->bound.isInside(x, y))
-        return this->m_default_value;
-    if (quadrant->ne)
+    double norm = std::hypot(direction_x, direction_y);
+    if (norm == 0)
+        throw epstl::value_exception("The direction of the ray can not be null");
+    ray_t ray{origin_x, origin_y, direction_x / norm, direction_y / norm,
+              max_range};
+    distance = max_range;
+    if (!this->m_root)
     {
-        auto** selected_quadrant = this->select_quadrant(quadrant, x, y);
-        if (!selected_quadrant)
-            return this->m_default_value;
-        return get_value(*selected_quadrant, x, y);
+        // Untouched tree: a single leaf with the default state
+        double enter;
+        if (!this->m_default_value || !ray_interval(root_bound(), ray, enter))
+            return false;
+        distance = enter;
+        return true;
     }
-    else
+    return cast_quadrant(this->m_root, ray, distance);
+}
+
+/**
+ * @brief Cast a fan of rays from the same origin
+ * @param origin_x X coordinate of the origin
+ * @param origin_y Y coordinate of the origin
+ * @param first_angle Angle of the first ray, in radians
+ * @param angle_step Angle between two rays, in radians
+ * @param count Number of rays
+ * @param max_range Length of the rays
+ * @param[out] distances Distance of each ray, see raycast
+ * @return Return the number of rays hitting a set cell
+ */
+template<typename key_t>
+size_t quadtree_region<key_t>::raycast_fan(double origin_x, double origin_y,
+        double first_angle, double angle_step, size_t count, double max_range,
+        double* distances) const
+{
+    size_t hits = 0;
+    for (size_t i = 0; i < count; i++)
     {
-        return quadrant->data;
+        double angle = first_angle + i * angle_step;
+        if (raycast(origin_x, origin_y, std::cos(angle), std::sin(angle),
+                    max_range, distances[i]))
+            hits++;
     }
+    return hits;
 }
 
 /**
- * @brief Get the value at the given position
+ * @brief Tells if the segment between two cells only crosses free cells
  *
- * Return the default value if there is nothing at the given coordinates
+ * The segment joins the centers of the cells, both cells need to be free.
  *
- * @warning Need to set m_exposed_default_value before calling the method
+ * @param from_x X coordinate of the first cell
+ * @param from_y Y coordinate of the first cell
+ * @param to_x X coordinate of the second cell
+ * @param to_y Y coordinate of the second cell
+ * @return Return true if no set cell is on the way
+ */
+template<typename key_t>
+bool quadtree_region<key_t>::line_of_sight(key_t from_x, key_t from_y,
+        key_t to_x, key_t to_y) const
+{
+    epstl::pair<double> from(cell_center(from_x), cell_center(from_y));
+    epstl::pair<double> to(cell_center(to_x), cell_center(to_y));
+    double length = distance(from, to);
+    if (length == 0)
+        return !this->at(from_x, from_y);
+    double hit;
+    return !raycast(from.first, from.second, to.first - from.first,
+                    to.second - from.second, length, hit);
+}
+
+/**
+ * @brief Find the set cell closest to a cell
  *
- * @param quadrant Quadrant to look into
- * @param x X coordinate to look for
- * @param y Y coordinate to look for
- * @return Mutable reference on the value
+ * Best-first search: the quadrants with a set cell are visited by distance
+ * to the cell, so the first set leaf reached holds the answer and the
+ * quadrants farther than it are never divided. The distance is measured
+ * between the cell coordinates. Only for integral keys.
+ *
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @param[out] nearest_x X coordinate of the closest set cell
+ * @param[out] nearest_y Y coordinate of the closest set cell
+ * @param max_distance Largest distance searched, negative finds nothing
+ * @return Return true if a set cell is not farther than the max distance
  */
 template<typename key_t>
-bool&
-quadtree_region<key_t>::get_value(typename quadtree<key_t, bool>::quadrant_t*
-                                  quadrant, key_t x, key_t y)
+bool quadtree_region<key_t>::nearest_set(key_t x, key_t y, key_t& nearest_x,
+        key_t& nearest_y, double max_distance) const
 {
-    if (!quadrant->bound.isInside(x, y))
-        return this->m_exposed_default_value;
-    if (quadrant->ne)
+    static_assert(std::is_integral<key_t>::value,
+                  "The distances need integral keys");
+    if (!(max_distance >= 0))
+        return false;
+    double max_squared = max_distance * max_distance;
+    if (!this->m_root)
+    {
+        // Untouched tree: a single leaf with the default state
+        return this->m_default_value &&
+               nearest_cell(root_bound(), x, y, nearest_x, nearest_y) <= max_squared;
+    }
+
+    // Quadrants by distance, in a standard heap (none in epstl)
+    typedef std::pair<double, const quadrant_t*> entry_t;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>
+            open;
+    key_t cell_x, cell_y;
+    if (this->m_root->count > 0)
+        open.push(entry_t(nearest_cell(this->m_root->bound, x, y, cell_x, cell_y),
+                          this->m_root));
+    while (!open.empty() && open.top().first <= max_squared)
     {
-        auto** selected_quadrant = this->select_quadrant(quadrant, x, y);
-        if (!selected_quadrant)
-            return this->m_exposed_default_value;
-        return get_value(*selected_quadrant, x, y);
+        const quadrant_t* quadrant = open.top().second;
+        open.pop();
+        if (quadrant->isLeaf())
+        {
+            nearest_cell(quadrant->bound, x, y, nearest_x, nearest_y);
+            return true;
+        }
+        for (const quadrant_t* child : quadrant->children)
+        {
+            if (child->count > 0)
+                open.push(entry_t(nearest_cell(child->bound, x, y, cell_x, cell_y),
+                                  child));
+        }
     }
+    return false;
+}
+
+/**
+ * @brief Point of the path for the cell coordinate
+ *
+ * The integer cells are reached at their center.
+ */
+template<typename key_t>
+double quadtree_region<key_t>::cell_center(key_t coordinate)
+{
+    if constexpr (std::is_integral<key_t>::value)
+        return coordinate + 0.5;
     else
+        return coordinate;
+}
+
+/**
+ * @brief Middle of the common side of two adjacent quadrants
+ * @param from First quadrant bounds
+ * @param to Second quadrant bounds
+ * @return Return the middle point
+ */
+template<typename key_t>
+epstl::pair<double> quadtree_region<key_t>::portal(const rect_bound_t& from,
+        const rect_bound_t& to)
+{
+    if (from.right == to.left || from.left == to.right)
+        return epstl::pair<double>(from.right == to.left ? from.right : from.left,
+                                   (epstl::max(from.bottom, to.bottom) +
+                                    epstl::min(from.top, to.top)) / 2.);
+    return epstl::pair<double>((epstl::max(from.left, to.left) +
+                                epstl::min(from.right, to.right)) / 2.,
+                               from.top == to.bottom ? from.top : from.bottom);
+}
+
+/**
+ * @brief Euclidean distance between two points
+ */
+template<typename key_t>
+double quadtree_region<key_t>::distance(const epstl::pair<double>& a,
+                                        const epstl::pair<double>& b)
+{
+    return std::hypot(a.first - b.first, a.second - b.second);
+}
+
+/**
+ * @brief Find the first set cell of the quadrant along the ray
+ * @param quadrant Quadrant to look into
+ * @param ray Ray cast
+ * @param[out] distance Distance to the cell, set only if one is hit
+ * @return Return true if a set cell was hit
+ */
+template<typename key_t>
+bool quadtree_region<key_t>::cast_quadrant(const quadrant_t* quadrant,
+        const ray_t& ray, double& distance) const
+{
+    if (quadrant->isLeaf())
     {
-        return quadrant->data;
+        double enter;
+        if (!quadrant->data || isEmpty(quadrant->bound) ||
+                !ray_interval(quadrant->bound, ray, enter))
+            return false;
+        distance = enter;
+        return true;
+    }
+    // The children crossed are sorted by entry distance
+    const quadrant_t* crossed[4];
+    double enters[4];
+    size_t count = 0;
+    for (const quadrant_t* child : quadrant->children)
+    {
+        double enter;
+        if (isEmpty(child->bound) || !ray_interval(child->bound, ray, enter))
+            continue;
+        size_t i = count++;
+        for (; i > 0 && enters[i - 1] > enter; i--)
+        {
+            crossed[i] = crossed[i - 1];
+            enters[i] = enters[i - 1];
+        }
+        crossed[i] = child;
+        enters[i] = enter;
     }
+    for (size_t i = 0; i < count; i++)
+    {
+        if (cast_quadrant(crossed[i], ray, distance))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Find where the ray enters the bounds
+ * @param bound Bounds crossed
+ * @param ray Ray cast
+ * @param[out] enter Distance from the origin to the bounds
+ * @return Return true if the ray crosses the bounds
+ */
+template<typename key_t>
+bool quadtree_region<key_t>::ray_interval(const rect_bound_t& bound,
+        const ray_t& ray, double& enter)
+{
+    enter = 0;
+    double exit = ray.range;
+    return ray_slab(bound.left, bound.right, ray.origin_x, ray.direction_x,
+                    enter, exit) &&
+           ray_slab(bound.bottom, bound.top, ray.origin_y, ray.direction_y,
+                    enter, exit);
+}
+
+/**
+ * @brief Clip the interval of the ray to a slab
+ * @param low Lower side of the slab
+ * @param high Upper side of the slab, excluded
+ * @param origin Coordinate of the origin across the slab
+ * @param direction Component of the direction across the slab
+ * @param[in,out] enter Start of the interval
+ * @param[in,out] exit End of the interval
+ * @return Return true if the interval is not empty
+ */
+template<typename key_t>
+bool quadtree_region<key_t>::ray_slab(double low, double high, double origin,
+                                      double direction, double& enter, double& exit)
+{
+    if (direction == 0)
+        return origin >= low && origin < high && enter < exit;
+    double first = (low - origin) / direction;
+    double last = (high - origin) / direction;
+    if (first > last)
+        std::swap(first, last);
+    enter = epstl::max(enter, first);
+    exit = epstl::min(exit, last);
+    return enter < exit;
+}
+
+/**
+ * @brief Find the root of the set in the union-find, halving the path
+ * @param parents Parent of each element
+ * @param index Element to look for
+ * @return Return the root of the set
+ */
+template<typename key_t>
+size_t quadtree_region<key_t>::find_set(vector<size_t>& parents, size_t index)
+{
+    while (parents[index] != index)
+    {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+    return index;
+}
+
+/**
+ * @brief Find the cell of the bounds closest to a cell
+ * @param bound Bounds of the cells
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @param[out] nearest_x X coordinate of the closest cell
+ * @param[out] nearest_y Y coordinate of the closest cell
+ * @return Squared distance between the cells
+ */
+template<typename key_t>
+double quadtree_region<key_t>::nearest_cell(const rect_bound_t& bound,
+        key_t x, key_t y, key_t& nearest_x, key_t& nearest_y)
+{
+    nearest_x = epstl::min(epstl::max(x, bound.left), bound.right - 1);
+    nearest_y = epstl::min(epstl::max(y, bound.bottom), bound.top - 1);
+    double dx = static_cast<double>(nearest_x) - x;
+    double dy = static_cast<double>(nearest_y) - y;
+    return dx * dx + dy * dy;
 }
 
 } // namespace epstl
@@ -0,0 +1,1719 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "geometry_tools.hpp"
+#include "polygon.hpp"
+#include "quadtree.hpp"
+#include "vector.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Data kept by region_quadtree in each quadrant
+ */
+template<typename value_t, bool arithmetic = std::is_arithmetic<value_t>::value
+         && !std::is_same<value_t, bool>::value>
+struct region_node_data_t
+{
+    static constexpr bool has_range = false; ///< Tracks the written values
+
+    size_t count = 0;   ///< Cells with a non-zero value
+    size_t epoch = 0;   ///< Epoch of the last change
+};
+
+/**
+ * @brief Data of the quadrants with arithmetic values
+ *
+ * The range of the values written in the cells, before any merge, bounds
+ * the error of the merges with a tolerance.
+ */
+template<typename value_t>
+struct region_node_data_t<value_t, true> :
+    public region_node_data_t<value_t, false>
+{
+    static constexpr bool has_range = true; ///< Tracks the written values
+
+    value_t low = 0;    ///< Smallest value written in the cells
+    value_t high = 0;   ///< Largest value written in the cells
+};
+
+/**
+ * @brief Region quadtree over any cell value
+ *
+ * Each leaf holds the value of all the cells it covers: the cell x,y covers
+ * [x, x+1[ * [y, y+1[. Four children with the same value are merged. The
+ * size is the number of cells with a non-zero value.
+ *
+ * For arithmetic values, a tolerance lets the siblings with close values
+ * merge too (set_tolerance): the merged leaf takes their mean weighted by
+ * area, so smooth maps compress like uniform ones.
+ *
+ * Each quadrant keeps the epoch of its last change. After a checkpoint(),
+ * changes_since() lists the leaves changed since then, without visiting
+ * the unchanged subtrees.
+ *
+ * Example :
+ * @code
+ * // Cost map of 20 by 20 cells, centered on zero.
+ * epstl::region_quadtree<int, uint8_t> costs(20, 20);
+ *
+ * costs.insert_rect(-10, -10, 10, 0, 5);
+ * costs.insert(3, 3, 200);
+ * costs.at(3, 3); // returns 200
+ * costs.size(); // returns 201
+ * @endcode
+ */
+template<typename key_t = int, typename value_t = bool>
+class region_quadtree : public quadtree<key_t, value_t,
+    region_node_data_t<value_t>>
+{
+  protected:
+    typedef quadtree<key_t, value_t, region_node_data_t<value_t>> tree_t;
+    typedef typename tree_t::quadrant_t quadrant_t;
+    typedef typename tree_t::rect_bound_t rect_bound_t;
+
+    /**
+     * @brief Side of a quadrant, for the neighbour finding
+     *
+     * Bit 0 is set for the positive sides.
+     */
+    enum direction_t
+    {
+        direction_west = 0,
+        direction_east = 1,
+        direction_south = 2,
+        direction_north = 3
+    };
+
+  public:
+    /**
+     * @brief Block of cells [left, right[ * [bottom, top[
+     */
+    struct rect_t
+    {
+        key_t left = 0;
+        key_t bottom = 0;
+        key_t right = 0;   ///< Excluded
+        key_t top = 0;     ///< Excluded
+    };
+
+    /**
+     * @brief Construct a quadtree with the given center and width/height
+     * @param center_x X coordinate of the center
+     * @param center_y Y coordinate of the center
+     * @param width Width of the root
+     * @param height Height of the root
+     */
+    explicit region_quadtree(key_t center_x, key_t center_y, key_t width,
+                             key_t height) :
+        tree_t(center_x, center_y, width, height, value_t()) {}
+
+    /**
+     * @brief Construct a quadtree centered on 0,0, with the given width/height
+     * @param width Width of the root
+     * @param height Height of the root
+     */
+    explicit region_quadtree(key_t width, key_t height) :
+        tree_t(0, 0, width, height) {}
+
+    /**
+     * @brief Construct a quadtree with the given center and width/height and the default value
+     * @param center_x X coordinate of the center
+     * @param center_y Y coordinate of the center
+     * @param width Width of the root
+     * @param height Height of the root
+     * @param default_value Default value to use
+     */
+    explicit region_quadtree(key_t center_x, key_t center_y, key_t width,
+                             key_t height, const value_t& default_value) :
+        tree_t(center_x, center_y, width, height, default_value) {}
+
+    explicit region_quadtree(const region_quadtree& copy) :
+        tree_t(copy), m_tolerance(copy.m_tolerance),
+        m_epoch(copy.m_epoch), m_rebuild_epoch(copy.m_rebuild_epoch) {}
+
+    explicit region_quadtree(region_quadtree&& move) :
+        tree_t(std::move(move)),
+        m_tolerance(move.m_tolerance), m_epoch(move.m_epoch),
+        m_rebuild_epoch(move.m_rebuild_epoch) {}
+    ~region_quadtree() override = default;
+
+    region_quadtree& operator=(const region_quadtree& copy)
+    {
+        tree_t::operator=(copy);
+        m_tolerance = copy.m_tolerance;
+        m_epoch = copy.m_epoch;
+        m_rebuild_epoch = copy.m_rebuild_epoch;
+        return *this;
+    }
+    region_quadtree& operator=(region_quadtree&& move)
+    {
+        tree_t::operator=(std::move(move));
+        m_tolerance = move.m_tolerance;
+        m_epoch = move.m_epoch;
+        m_rebuild_epoch = move.m_rebuild_epoch;
+        return *this;
+    }
+
+    /**
+     * @brief Get the largest difference between merged siblings
+     */
+    double tolerance() const noexcept
+    {
+        return m_tolerance;
+    }
+
+    void set_tolerance(double tolerance);
+
+    /**
+     * @brief Epoch given to the changes made now
+     */
+    size_t epoch() const noexcept
+    {
+        return m_epoch;
+    }
+
+    /**
+     * @brief Close the current epoch
+     *
+     * changes_since() with the returned epoch lists the changes made after
+     * the checkpoint.
+     * @return Epoch of the changes made before the checkpoint
+     */
+    size_t checkpoint() noexcept
+    {
+        return m_epoch++;
+    }
+
+    size_t changes_since(size_t epoch, vector<rect_t>& changed) const;
+    size_t region_diff(const region_quadtree& other,
+                       vector<rect_t>& changed) const;
+
+    size_t insert(key_t x, key_t y, const value_t& item) override;
+    size_t insert_region(const vector<key_t>& polygon_points,
+                         const value_t& item);
+    template<typename k_type>
+    size_t insert_region(const Polygon<k_type>& polygon, const value_t& item);
+    size_t insert_rect(key_t left, key_t bottom, key_t right, key_t top,
+                       const value_t& item);
+
+    size_t count_set(key_t left, key_t bottom, key_t right, key_t top) const;
+    double coverage(key_t left, key_t bottom, key_t right, key_t top) const;
+
+    size_t leaf_count() const;
+
+    double at_level(key_t x, key_t y, size_t level) const;
+    size_t downsample(size_t level, double* fractions) const;
+
+    size_t contains(const key_t* xs, const key_t* ys, size_t count,
+                    bool* inside) const;
+
+    size_t encode(std::ostream& stream) const;
+    size_t decode(std::istream& stream);
+
+    void print(std::ostream& stream) const override;
+
+    static bool isInside(const vector<key_t>& polygon, double x, double y);
+
+  protected:
+    /**
+     * @brief Write bits in a stream, the least significant bit of each byte
+     * first
+     */
+    struct bit_writer_t
+    {
+        explicit bit_writer_t(std::ostream& stream) : stream(stream) {}
+
+        void write(bool bit)
+        {
+            if (bit)
+                byte |= 1 << count;
+            if (++count == 8)
+                flush();
+        }
+
+        void flush()
+        {
+            if (count == 0)
+                return;
+            stream.put(static_cast<char>(byte));
+            bytes++;
+            byte = 0;
+            count = 0;
+        }
+
+        std::ostream& stream;
+        uint8_t byte = 0;   ///< Bits not written yet
+        uint8_t count = 0;  ///< Number of bits in byte
+        size_t bytes = 0;   ///< Number of bytes written
+    };
+
+    /**
+     * @brief Read the bits written by bit_writer_t
+     */
+    struct bit_reader_t
+    {
+        explicit bit_reader_t(std::istream& stream) : stream(stream) {}
+
+        bool read()
+        {
+            if (count == 0)
+            {
+                int next = stream.get();
+                if (next == std::istream::traits_type::eof())
+                    throw epstl::value_exception("The encoding ends too early");
+                byte = static_cast<uint8_t>(next);
+                count = 8;
+            }
+            bool bit = byte & 1;
+            byte >>= 1;
+            count--;
+            return bit;
+        }
+
+        std::istream& stream;
+        uint8_t byte = 0;   ///< Bits not read yet
+        uint8_t count = 0;  ///< Number of bits in byte
+    };
+
+    void create_root();
+    void reset();
+    rect_bound_t root_bound() const;
+    bool insert_quadrant(quadrant_t* quadrant, key_t x, key_t y,
+                         const value_t& item) override;
+    template<typename k_type>
+    void fill_quadrant(quadrant_t* quadrant, const Polygon<k_type>& polygon,
+                       const vector<size_t>& edges, const value_t& item);
+    void fill_rect_quadrant(quadrant_t* quadrant, key_t left, key_t bottom,
+                            key_t right, key_t top, const value_t& item);
+    template<typename k_type>
+    static bool crosses(const Polygon<k_type>& polygon, size_t edge,
+                        const rect_bound_t& bound);
+    void assign_quadrant(quadrant_t* quadrant, const value_t& item);
+    void split_leaf(quadrant_t* quadrant);
+    void update_quadrant(quadrant_t* quadrant);
+    bool merge_value(const quadrant_t* quadrant, value_t& merged) const;
+    size_t count_set_quadrant(const quadrant_t* quadrant, key_t left,
+                              key_t bottom, key_t right, key_t top) const;
+    size_t leaf_count(const quadrant_t* quadrant) const;
+    void downsample_quadrant(const quadrant_t* quadrant, size_t col, size_t row,
+                             size_t span, size_t side, double* fractions) const;
+    static double fraction(const quadrant_t* quadrant);
+    static uint64_t morton_code(uint32_t x, uint32_t y);
+    void changes_quadrant(const quadrant_t* quadrant, size_t epoch,
+                          vector<rect_t>& changed) const;
+    size_t region_diff_quadrant(const quadrant_t* quadrant,
+                                const quadrant_t* other_quadrant,
+                                const value_t& other_value,
+                                vector<rect_t>& changed) const;
+    static void push_rect(const rect_bound_t& bound, vector<rect_t>& rects);
+    const quadrant_t* equal_neighbour(const quadrant_t* quadrant,
+                                      direction_t direction) const;
+    void neighbour_leaves(const quadrant_t* quadrant, direction_t direction,
+                          vector<const quadrant_t*>& leaves) const;
+    void side_leaves(const quadrant_t* quadrant, direction_t side,
+                     const rect_bound_t& facing,
+                     vector<const quadrant_t*>& leaves) const;
+    const quadrant_t* leaf_at(key_t x, key_t y) const;
+    void collect_leaves(const quadrant_t* quadrant, const value_t& item,
+                        vector<const quadrant_t*>& leaves) const;
+    static uint8_t child_index(const quadrant_t* quadrant);
+    static size_t area(const rect_bound_t& bound);
+    static bool isEmpty(const rect_bound_t& bound);
+    static bool isZero(const value_t& value);
+    void encode_quadrant(const quadrant_t* quadrant, bit_writer_t& writer) const;
+    void decode_quadrant(quadrant_t* quadrant, bit_reader_t& reader);
+    static void write_value(const value_t& value, bit_writer_t& writer);
+    static value_t read_value(bit_reader_t& reader);
+    const value_t& get_value(quadrant_t* quadrant, key_t x,
+                             key_t y) const override;
+    value_t& get_value(quadrant_t* quadrant, key_t x, key_t y) override;
+
+    /// Number of vertices from which insert_region builds the slabs
+    static constexpr size_t slab_vertices = 32;
+
+    double m_tolerance = 0; ///< Largest range of the values merged
+    size_t m_epoch = 1;         ///< Epoch given to the changes made now
+    size_t m_rebuild_epoch = 0; ///< Epoch of the last full replacement
+};
+
+/**
+ * @brief Insert the item at the given coordinates
+ *
+ * Only the path from the root to the cell is visited, the merge is checked
+ * on the way back.
+ *
+ * @param x X coordinate of the item
+ * @param y Y coordinate of the item
+ * @param item Item to copy in the tree
+ * @return Size of the new tree (number of items)
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::insert(key_t x, key_t y,
+        const value_t& item)
+{
+    create_root();
+    insert_quadrant(this->m_root, x, y, item);
+
+    return this->m_size;
+}
+
+/**
+ * @brief Set the value of the cells inside the polygon
+ *
+ * A cell is inside when its center is inside the polygon (even-odd rule).
+ * The quadrants not crossed by the edges are assigned at once, only the
+ * quadrants along the edges are divided, so the cost depends on the
+ * perimeter of the polygon and not on its area.
+ *
+ * @param polygon_points Vertices of the polygon: x0, y0, x1, y1, ...
+ * @param item Value to give to the cells
+ * @return Size of the new tree (number of non-zero cells)
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::insert_region(const vector<key_t>&
+        polygon_points, const value_t& item)
+{
+    if (polygon_points.size() % 2 != 0 || polygon_points.size() < 6)
+        throw epstl::value_exception("The polygon needs at least 3 vertices, given as x, y pairs");
+    Polygon<double> polygon(&polygon_points[0], polygon_points.size() / 2);
+    // Each leaf along the edges tests its center against the polygon
+    if (polygon.size() >= slab_vertices)
+        polygon.build_slabs();
+    return insert_region(polygon, item);
+}
+
+/**
+ * @brief Set the value of the cells inside the polygon
+ *
+ * Same as the insertion of the vertices, the slabs of the polygon (if
+ * built) speed up the test of the cells along the edges.
+ *
+ * @param polygon Polygon to fill
+ * @param item Value to give to the cells
+ * @return Size of the new tree (number of non-zero cells)
+ */
+template<typename key_t, typename value_t>
+template<typename k_type>
+size_t region_quadtree<key_t, value_t>::insert_region(const Polygon<k_type>&
+        polygon, const value_t& item)
+{
+    if (polygon.size() < 3)
+        throw epstl::value_exception("The polygon needs at least 3 vertices");
+    create_root();
+
+    vector<size_t> edges;
+    for (size_t i = 0; i < polygon.size(); i++)
+        edges.push_back(i);
+    fill_quadrant(this->m_root, polygon, edges, item);
+
+    return this->size();
+}
+
+/**
+ * @brief Count the non-zero cells inside the rectangle
+ * [left, right[ * [bottom, top[
+ *
+ * The quadrants inside the rectangle give their count at once, only the
+ * quadrants crossing the sides of the rectangle are divided.
+ *
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (excluded)
+ * @param top Top of the rectangle (excluded)
+ * @return Number of non-zero cells
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::count_set(key_t left, key_t bottom,
+        key_t right, key_t top) const
+{
+    if (!this->m_root || !(left < right) || !(bottom < top))
+        return 0;
+    return count_set_quadrant(this->m_root, left, bottom, right, top);
+}
+
+/**
+ * @brief Ratio of non-zero cells inside the rectangle [left, right[ * [bottom, top[
+ *
+ * The cells outside of the tree count as zero.
+ *
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (excluded)
+ * @param top Top of the rectangle (excluded)
+ * @return Ratio between 0 and 1, 0 for an empty rectangle
+ */
+template<typename key_t, typename value_t>
+double region_quadtree<key_t, value_t>::coverage(key_t left, key_t bottom,
+        key_t right, key_t top) const
+{
+    if (!(left < right) || !(bottom < top))
+        return 0;
+    return count_set(left, bottom, right, top) /
+           (static_cast<double>(right - left) * (top - bottom));
+}
+
+/**
+ * @brief Set the largest range of the values merged in a leaf
+ *
+ * Only for arithmetic values. The merged leaf takes the mean of its
+ * children. Each quadrant keeps the range of the values written in its
+ * cells, and the children merge only if the range of all their values is
+ * within the tolerance, so a cell never moves farther than the tolerance
+ * from the value written to it, whatever the number of levels merged. An
+ * update close to the values around it may still be merged away. Only the
+ * next updates are affected.
+ *
+ * @param tolerance Largest range, 0 to merge only equal values
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::set_tolerance(double tolerance)
+{
+    static_assert(std::is_arithmetic<value_t>::value &&
+                  !std::is_same<value_t, bool>::value,
+                  "The tolerance needs arithmetic values");
+    if (tolerance < 0)
+        throw epstl::value_exception("The tolerance can not be negative");
+    m_tolerance = tolerance;
+}
+
+/**
+ * @brief Number of leaves of the tree, to measure the compression
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::leaf_count() const
+{
+    return this->m_root ? leaf_count(this->m_root) : 1;
+}
+
+/**
+ * @brief Ratio of non-zero cells in the quadrant of the given level
+ *
+ * The descent stops at the level, the ratio comes from the count kept in
+ * each quadrant: 0 if no cell is set, 1 if all the cells are set.
+ *
+ * @param x X coordinate of a cell of the quadrant
+ * @param y Y coordinate of a cell of the quadrant
+ * @param level Number of divisions from the root
+ * @return Ratio between 0 and 1, 0 outside of the tree
+ */
+template<typename key_t, typename value_t>
+double region_quadtree<key_t, value_t>::at_level(key_t x, key_t y,
+        size_t level) const
+{
+    if (!this->m_root)
+        return root_bound().isInside(x, y) && !isZero(this->m_default_value);
+    const quadrant_t* quadrant = this->m_root;
+    if (!quadrant->bound.isInside(x, y))
+        return 0;
+    while (!quadrant->isLeaf() && quadrant->level < level)
+        quadrant = quadrant->children[quadrant->bound.childIndex(x, y)];
+    return fraction(quadrant);
+}
+
+/**
+ * @brief Ratio of non-zero cells of each quadrant of the given level
+ *
+ * The quadrants of the level make a grid of 2^level by 2^level blocks, the
+ * first row is the bottom of the tree. A leaf above the level fills all the
+ * blocks it covers. The quadrants below the level are not visited.
+ *
+ * @param level Number of divisions from the root
+ * @param[out] fractions Ratio of each block, 4^level values
+ * @return Number of blocks by row
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::downsample(size_t level,
+        double* fractions) const
+{
+    size_t side = static_cast<size_t>(1) << level;
+    if (!this->m_root)
+    {
+        double ratio = isZero(this->m_default_value) ? 0 : 1;
+        for (size_t i = 0; i < side * side; i++)
+            fractions[i] = ratio;
+        return side;
+    }
+    downsample_quadrant(this->m_root, 0, 0, side, side, fractions);
+    return side;
+}
+
+/**
+ * @brief Tells which points are on a non-zero cell
+ *
+ * The points are sorted along a Morton curve, so that consecutive points
+ * share most of their descent: the search climbs from the previous leaf to
+ * the first quadrant containing the next point instead of starting again
+ * from the root. The points outside of the tree get the default value.
+ *
+ * @param xs X coordinates of the points
+ * @param ys Y coordinates of the points
+ * @param count Number of points
+ * @param[out] inside True for each point on a non-zero cell
+ * @return Number of points on a non-zero cell
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::contains(const key_t* xs,
+        const key_t* ys, size_t count, bool* inside) const
+{
+    bool outside = !isZero(this->m_default_value);
+    size_t inside_count = 0;
+    if (!this->m_root)
+    {
+        for (size_t i = 0; i < count; i++)
+            inside[i] = outside;
+        return outside ? count : 0;
+    }
+
+    const rect_bound_t& bound = this->m_root->bound;
+    // std::vector for reserve, std::sort and back(), missing in epstl::vector
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (bound.isInside(xs[i], ys[i]))
+        {
+            uint32_t x = static_cast<uint32_t>(xs[i] - bound.left);
+            uint32_t y = static_cast<uint32_t>(ys[i] - bound.bottom);
+            order.emplace_back(morton_code(x, y), i);
+        }
+        else
+        {
+            inside[i] = outside;
+            inside_count += outside;
+        }
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<const quadrant_t*> path{this->m_root};
+    for (const auto& point : order)
+    {
+        key_t x = xs[point.second];
+        key_t y = ys[point.second];
+        while (!path.back()->bound.isInside(x, y))
+            path.pop_back();
+        const quadrant_t* quadrant = path.back();
+        while (!quadrant->isLeaf())
+        {
+            quadrant = quadrant->children[quadrant->bound.childIndex(x, y)];
+            path.push_back(quadrant);
+        }
+        inside[point.second] = !isZero(quadrant->data);
+        inside_count += inside[point.second];
+    }
+    return inside_count;
+}
+
+/**
+ * @brief List the blocks changed after the checkpoint
+ *
+ * Only the subtrees changed after the checkpoint are visited. The leaves
+ * changed are listed whole, the cells of a leaf merged after the checkpoint
+ * may have kept their value. The whole tree is listed if it was replaced
+ * (decode) since then.
+ *
+ * @param epoch Epoch returned by checkpoint()
+ * @param[out] changed Blocks of changed cells, added at the end
+ * @return Number of blocks added
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::changes_since(size_t epoch,
+        vector<rect_t>& changed) const
+{
+    size_t previous_size = changed.size();
+    if (m_rebuild_epoch > epoch)
+        push_rect(root_bound(), changed);
+    else if (this->m_root)
+        changes_quadrant(this->m_root, epoch, changed);
+    return changed.size() - previous_size;
+}
+
+/**
+ * @brief List the blocks where the two trees have different values
+ *
+ * Both trees are traversed together: the quadrants divided on both sides
+ * are compared child by child, and a leaf is compared with the leaves of
+ * the other side under it.
+ *
+ * @param other Tree with the same center and dimensions
+ * @param[out] changed Blocks of cells with different values, added at the
+ * end
+ * @return Number of cells with different values
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::region_diff(const region_quadtree&
+        other, vector<rect_t>& changed) const
+{
+    if (this->m_center.x != other.m_center.x ||
+            this->m_center.y != other.m_center.y ||
+            this->m_width != other.m_width || this->m_height != other.m_height)
+        throw epstl::value_exception("The regions need to have the same bounds");
+    if (this->m_root)
+        return region_diff_quadrant(this->m_root, other.m_root,
+                                    other.m_default_value, changed);
+    if (other.m_root)
+        return region_diff_quadrant(other.m_root, nullptr,
+                                    this->m_default_value, changed);
+    if (this->m_default_value == other.m_default_value)
+        return 0;
+    push_rect(root_bound(), changed);
+    return area(root_bound());
+}
+
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::print(std::ostream& stream) const
+{
+    if (!this->m_root)
+    {
+        stream << "Empty quadtree\n";
+        return;
+    }
+    stream << "Tree:\n";
+    const rect_bound_t& bound = this->m_root->bound;
+    for (key_t row = bound.top - 1; row >= bound.bottom; row--)
+    {
+        for (key_t col = bound.left; col < bound.right; col++)
+        {
+            const value_t& value = this->at(col, row);
+            if constexpr (std::is_arithmetic<value_t>::value)
+                stream << +value << " ";
+            else
+                stream << value << " ";
+        }
+        stream << "\n";
+    }
+}
+
+/**
+ * @brief Write the tree in a compact form
+ *
+ * The quadrants are written depth first: a 1 bit for a divided quadrant,
+ * followed by its children, or a 0 bit for a leaf, followed by its value
+ * (1 bit for a boolean, the bytes of the value else). The quadrants without
+ * any cell are skipped. The size of the encoding depends on the number of
+ * leaves, not on the number of cells.
+ *
+ * @param stream Binary stream to write to
+ * @return Number of bytes written
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::encode(std::ostream& stream) const
+{
+    static_assert(std::is_trivially_copyable<value_t>::value,
+                  "The encoding needs trivially copyable values");
+    bit_writer_t writer(stream);
+    if (this->m_root)
+    {
+        encode_quadrant(this->m_root, writer);
+    }
+    else
+    {
+        // Untouched tree: a single leaf with the default value
+        writer.write(false);
+        write_value(this->m_default_value, writer);
+    }
+    writer.flush();
+    return writer.bytes;
+}
+
+/**
+ * @brief Replace the content of the tree by an encoded tree
+ *
+ * The tree is built while the stream is read. The encoded tree needs the
+ * same center and dimensions (see encode). The tree is emptied if the
+ * stream is too short or divides a quadrant that can not be divided.
+ *
+ * @param stream Binary stream to read from
+ * @return Size of the new tree (number of non-zero cells)
+ * @throw epstl::value_exception if the stream is not a valid encoding
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::decode(std::istream& stream)
+{
+    static_assert(std::is_trivially_copyable<value_t>::value,
+                  "The encoding needs trivially copyable values");
+    reset();
+    bit_reader_t reader(stream);
+    create_root();
+    try
+    {
+        decode_quadrant(this->m_root, reader);
+    }
+    catch (const epstl::value_exception&)
+    {
+        reset();
+        throw;
+    }
+    return this->m_size;
+}
+
+/**
+ * @brief Set the value of the cells inside the rectangle
+ *
+ * A cell is inside when its center is in [left, right[ * [bottom, top[. The
+ * quadrants covered by the rectangle are assigned at once, only the
+ * quadrants along its sides are divided.
+ *
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (excluded)
+ * @param top Top of the rectangle (excluded)
+ * @param item Value to give to the cells
+ * @return Size of the new tree (number of non-zero cells)
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::insert_rect(key_t left, key_t bottom,
+        key_t right, key_t top, const value_t& item)
+{
+    if (!(left < right) || !(bottom < top))
+        return this->m_size;
+    create_root();
+    fill_rect_quadrant(this->m_root, left, bottom, right, top, item);
+    return this->m_size;
+}
+
+/**
+ * @brief Tells if the point is inside the polygon (even-odd rule)
+ *
+ * @param polygon Vertices of the polygon: x0, y0, x1, y1, ...
+ * @param x X coordinate of the point
+ * @param y Y coordinate of the point
+ * @return Return true if the point is inside
+ */
+template<typename key_t, typename value_t>
+bool region_quadtree<key_t, value_t>::isInside(const vector<key_t>& polygon,
+        double x, double y)
+{
+    if (polygon.size() < 2)
+        return false;
+    return point_in_polygon(&polygon[0], polygon.size() / 2, x, y);
+}
+
+/**
+ * @brief Create the root quadrant if it does not exist
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::create_root()
+{
+    if (this->m_root)
+        return;
+    this->m_root = new quadrant_t;
+    this->m_root->bound = root_bound();
+    this->m_root->data = this->m_default_value;
+    if constexpr (quadrant_t::has_range)
+        this->m_root->low = this->m_root->high = this->m_default_value;
+    this->m_root->count = isZero(this->m_default_value) ? 0 :
+                          area(this->m_root->bound);
+    this->m_size = this->m_root->count;
+}
+
+/**
+ * @brief Delete all the quadrants
+ *
+ * The whole tree counts as changed for the previous epochs.
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::reset()
+{
+    this->free_quadrant(this->m_root);
+    this->m_root = nullptr;
+    this->m_size = 0;
+    m_rebuild_epoch = m_epoch;
+    this->m_depth = 0;
+    this->m_depth_outdated = false;
+}
+
+/**
+ * @brief Bounds of the root quadrant, even if it is not created yet
+ */
+template<typename key_t, typename value_t>
+typename region_quadtree<key_t, value_t>::rect_bound_t
+region_quadtree<key_t, value_t>::root_bound() const
+{
+    rect_bound_t bound;
+    bound.left = this->m_center.x - this->m_width / 2.;
+    bound.right = bound.left + this->m_width;
+    bound.bottom = this->m_center.y - this->m_height / 2.;
+    bound.top = bound.bottom + this->m_height;
+    bound.center = this->m_center;
+    return bound;
+}
+
+/**
+ * @brief Insert the item on the quadrant at the given coordinates
+ *
+ * @param quadrant Quadrant to use (for recursive use)
+ * @param x X coordinate of the item to insert
+ * @param y Y coordinate of the item to insert
+ * @param item Item to copy into the tree
+ * @return true if the quadrant has been changed
+ */
+template<typename key_t, typename value_t>
+bool region_quadtree<key_t, value_t>::insert_quadrant(quadrant_t* quadrant,
+        key_t x, key_t y, const value_t& item)
+{
+    if (!quadrant)
+        throw epstl::implementation_exception("insertion in a null quadrant");
+    if (!quadrant->bound.isInside(x, y))
+        return false;
+    if (!quadrant->isLeaf()) // If there is a quadrant division
+    {
+        bool modified = insert_quadrant(
+                            quadrant->children[quadrant->bound.childIndex(x, y)], x, y, item);
+        if (modified)
+            update_quadrant(quadrant);
+        return modified;
+    }
+
+    if (quadrant->data == item)
+        return false;
+
+    if (!this->can_split(quadrant))
+    {
+        assign_quadrant(quadrant, item);
+        return true;
+    }
+
+    // Division: the children keep the value of the parent
+    split_leaf(quadrant);
+    insert_quadrant(quadrant->children[quadrant->bound.childIndex(x, y)], x, y,
+                    item);
+    update_quadrant(quadrant);
+    return true;
+}
+
+/**
+ * @brief Recursive method for insert_region
+ *
+ * @param quadrant Quadrant to fill
+ * @param polygon Vertices of the polygon
+ * @param edges Edges crossing the parent quadrant
+ * @param item Value to give to the cells inside the polygon
+ */
+template<typename key_t, typename value_t>
+template<typename k_type>
+void region_quadtree<key_t, value_t>::fill_quadrant(quadrant_t* quadrant,
+        const Polygon<k_type>& polygon, const vector<size_t>& edges,
+        const value_t& item)
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound))
+        return;
+
+    vector<size_t> crossing;
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        if (crosses(polygon, edges[i], bound))
+            crossing.push_back(edges[i]);
+    }
+
+    // Without any edge, the whole quadrant is on the same side. The cells of
+    // a leaf which can not be divided follow their center.
+    if (crossing.size() == 0 || (quadrant->isLeaf() && !this->can_split(quadrant)))
+    {
+        if (polygon.contains((bound.left + bound.right) / 2.,
+                             (bound.bottom + bound.top) / 2.))
+            assign_quadrant(quadrant, item);
+        return;
+    }
+
+    if (quadrant->isLeaf())
+    {
+        if (quadrant->data == item)
+            return;
+        split_leaf(quadrant);
+    }
+    for (quadrant_t* child : quadrant->children)
+        fill_quadrant(child, polygon, crossing, item);
+    update_quadrant(quadrant);
+}
+
+/**
+ * @brief Recursive method for insert_rect
+ *
+ * @param quadrant Quadrant to fill
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (excluded)
+ * @param top Top of the rectangle (excluded)
+ * @param item Value to give to the cells inside the rectangle
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::fill_rect_quadrant(quadrant_t* quadrant,
+        key_t left, key_t bottom, key_t right, key_t top, const value_t& item)
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound) || bound.right <= left || bound.left >= right ||
+            bound.top <= bottom || bound.bottom >= top)
+        return;
+    if (bound.left >= left && bound.right <= right && bound.bottom >= bottom &&
+            bound.top <= top)
+    {
+        assign_quadrant(quadrant, item);
+        return;
+    }
+
+    if (quadrant->isLeaf())
+    {
+        if (quadrant->data == item)
+            return;
+        if (!this->can_split(quadrant))
+        {
+            // The cells of the leaf follow its center
+            double x = (bound.left + bound.right) / 2.;
+            double y = (bound.bottom + bound.top) / 2.;
+            if (x >= left && x < right && y >= bottom && y < top)
+                assign_quadrant(quadrant, item);
+            return;
+        }
+        split_leaf(quadrant);
+    }
+    for (quadrant_t* child : quadrant->children)
+        fill_rect_quadrant(child, left, bottom, right, top, item);
+    update_quadrant(quadrant);
+}
+
+/**
+ * @brief Tells if the edge of the polygon may cross the bounds
+ *
+ * The edge crosses the bounds if their boxes overlap and if the corners of
+ * the bounds are not all on the same side of the edge line.
+ *
+ * @param polygon Vertices of the polygon
+ * @param edge Index of the edge, from the vertex edge to the next one
+ * @param bound Bounds to test (closed)
+ * @return Return true if the edge crosses the bounds
+ */
+template<typename key_t, typename value_t>
+template<typename k_type>
+bool region_quadtree<key_t, value_t>::crosses(const Polygon<k_type>& polygon,
+        size_t edge, const rect_bound_t& bound)
+{
+    typename Polygon<k_type>::edge_t side = polygon.edge(edge);
+    double x0 = side.start.x();
+    double y0 = side.start.y();
+    double x1 = side.end.x();
+    double y1 = side.end.y();
+    if (epstl::max(x0, x1) < bound.left || epstl::min(x0, x1) > bound.right ||
+            epstl::max(y0, y1) < bound.bottom || epstl::min(y0, y1) > bound.top)
+        return false;
+
+    double dx = x1 - x0;
+    double dy = y1 - y0;
+    double sides[4] =
+    {
+        dx * (bound.bottom - y0) - dy * (bound.left - x0),
+        dx * (bound.bottom - y0) - dy * (bound.right - x0),
+        dx * (bound.top - y0) - dy * (bound.left - x0),
+        dx * (bound.top - y0) - dy * (bound.right - x0)
+    };
+    bool above = true;
+    bool below = true;
+    for (double side : sides)
+    {
+        above &= side > 0;
+        below &= side < 0;
+    }
+    return !above && !below;
+}
+
+/**
+ * @brief Give the value to all the cells of the quadrant
+ *
+ * The children are deleted. The quadrant takes the current epoch if its
+ * cells change.
+ * @param quadrant Quadrant to assign
+ * @param item Value of the cells
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::assign_quadrant(quadrant_t* quadrant,
+        const value_t& item)
+{
+    if (!quadrant->isLeaf() || !(quadrant->data == item))
+        quadrant->epoch = m_epoch;
+    this->m_size -= quadrant->count;
+    this->free_children(quadrant);
+    quadrant->data = item;
+    if constexpr (quadrant_t::has_range)
+        quadrant->low = quadrant->high = item;
+    quadrant->count = isZero(item) ? 0 : area(quadrant->bound);
+    this->m_size += quadrant->count;
+}
+
+/**
+ * @brief Divide the leaf, the children keep its value
+ * @param quadrant Leaf to divide
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::split_leaf(quadrant_t* quadrant)
+{
+    this->create_quadrants(quadrant);
+    for (quadrant_t* child : quadrant->children)
+    {
+        child->data = quadrant->data;
+        if constexpr (quadrant_t::has_range)
+        {
+            child->low = quadrant->low;
+            child->high = quadrant->high;
+        }
+        child->count = isZero(child->data) ? 0 : area(child->bound);
+        child->epoch = quadrant->epoch;
+    }
+}
+
+/**
+ * @brief Merge the children if they are leaves with the same value, else
+ * update the count of the quadrant
+ *
+ * The quadrant takes the latest epoch of its children.
+ *
+ * The children without any cell are ignored.
+ * @param quadrant Divided quadrant to merge
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::update_quadrant(quadrant_t* quadrant)
+{
+    size_t count = 0;
+    for (const quadrant_t* child : quadrant->children)
+    {
+        count += child->count;
+        quadrant->epoch = epstl::max(quadrant->epoch, child->epoch);
+    }
+    value_t merged;
+    if (!merge_value(quadrant, merged))
+    {
+        quadrant->count = count;
+        return;
+    }
+    if constexpr (quadrant_t::has_range)
+    {
+        // The leaf keeps the range of the values written in all its cells
+        bool first = true;
+        for (const quadrant_t* child : quadrant->children)
+        {
+            if (isEmpty(child->bound))
+                continue;
+            quadrant->low = first ? child->low :
+                            epstl::min(quadrant->low, child->low);
+            quadrant->high = first ? child->high :
+                             epstl::max(quadrant->high, child->high);
+            first = false;
+        }
+    }
+    this->free_children(quadrant);
+    quadrant->data = merged;
+    quadrant->count = isZero(merged) ? 0 : area(quadrant->bound);
+    this->m_size = this->m_size - count + quadrant->count;
+}
+
+/**
+ * @brief Value of the quadrant if its children can be merged
+ *
+ * The children need to be leaves with the same value, or the values written
+ * in all their cells must be within the tolerance. In the latter case the
+ * value is their mean weighted by area, rounded for the integral values.
+ *
+ * @param quadrant Divided quadrant
+ * @param[out] merged Value of the merged leaf
+ * @return Return true if the children can be merged
+ */
+template<typename key_t, typename value_t>
+bool region_quadtree<key_t, value_t>::merge_value(const quadrant_t* quadrant,
+        value_t& merged) const
+{
+    const quadrant_t* reference = nullptr;
+    bool uniform = true;
+    for (const quadrant_t* child : quadrant->children)
+    {
+        if (isEmpty(child->bound))
+            continue;
+        if (!child->isLeaf())
+            return false;
+        if (!reference)
+            reference = child;
+        else if (!(child->data == reference->data))
+            uniform = false;
+    }
+    merged = reference ? reference->data : quadrant->data;
+    if (uniform)
+        return true;
+
+    if constexpr (quadrant_t::has_range)
+    {
+        if (m_tolerance <= 0)
+            return false;
+        // The written values, not the current ones: the error of the merges
+        // does not add up over the levels
+        double low = static_cast<double>(reference->low);
+        double high = static_cast<double>(reference->high);
+        double sum = 0;
+        size_t cells = 0;
+        for (const quadrant_t* child : quadrant->children)
+        {
+            if (isEmpty(child->bound))
+                continue;
+            double value = static_cast<double>(child->data);
+            low = epstl::min(low, static_cast<double>(child->low));
+            high = epstl::max(high, static_cast<double>(child->high));
+            sum += value * area(child->bound);
+            cells += area(child->bound);
+        }
+        if (high - low > m_tolerance)
+            return false;
+        double mean = sum / cells;
+        if constexpr (std::is_integral<value_t>::value)
+            mean = std::round(mean);
+        merged = static_cast<value_t>(mean);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Recursive method for count_set
+ *
+ * @param quadrant Quadrant to look into
+ * @param left Left of the rectangle
+ * @param bottom Bottom of the rectangle
+ * @param right Right of the rectangle (excluded)
+ * @param top Top of the rectangle (excluded)
+ * @return Number of non-zero cells of the quadrant inside the rectangle
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::count_set_quadrant(
+    const quadrant_t* quadrant, key_t left, key_t bottom, key_t right,
+    key_t top) const
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound) || bound.right <= left || bound.left >= right ||
+            bound.top <= bottom || bound.bottom >= top)
+        return 0;
+    if (quadrant->isLeaf())
+    {
+        if (isZero(quadrant->data))
+            return 0;
+        rect_bound_t overlap;
+        overlap.left = epstl::max(bound.left, left);
+        overlap.right = epstl::min(bound.right, right);
+        overlap.bottom = epstl::max(bound.bottom, bottom);
+        overlap.top = epstl::min(bound.top, top);
+        return area(overlap);
+    }
+    if (bound.left >= left && bound.right <= right && bound.bottom >= bottom &&
+            bound.top <= top)
+        return quadrant->count;
+
+    size_t count = 0;
+    for (const quadrant_t* child : quadrant->children)
+        count += count_set_quadrant(child, left, bottom, right, top);
+    return count;
+}
+
+/**
+ * @brief Recursive method for leaf_count
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::leaf_count(const quadrant_t* quadrant)
+const
+{
+    if (isEmpty(quadrant->bound))
+        return 0;
+    if (quadrant->isLeaf())
+        return 1;
+    size_t count = 0;
+    for (const quadrant_t* child : quadrant->children)
+        count += leaf_count(child);
+    return count;
+}
+
+/**
+ * @brief Recursive method for downsample
+ * @param quadrant Quadrant to write
+ * @param col First column of the quadrant in the grid
+ * @param row First row of the quadrant in the grid
+ * @param span Number of blocks covered by the quadrant, by row
+ * @param side Number of blocks by row of the grid
+ * @param[out] fractions Grid to fill
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::downsample_quadrant(const quadrant_t*
+        quadrant, size_t col, size_t row, size_t span, size_t side,
+        double* fractions) const
+{
+    if (span == 1 || quadrant->isLeaf())
+    {
+        double ratio = fraction(quadrant);
+        for (size_t i = row; i < row + span; i++)
+            for (size_t j = col; j < col + span; j++)
+                fractions[i * side + j] = ratio;
+        return;
+    }
+    span /= 2;
+    for (uint8_t i = 0; i < 4; i++)
+        downsample_quadrant(quadrant->children[i],
+                            i & quadrant_se ? col + span : col,
+                            i & quadrant_nw ? row + span : row, span, side,
+                            fractions);
+}
+
+/**
+ * @brief Ratio of non-zero cells of the quadrant, 0 without any cell
+ */
+template<typename key_t, typename value_t>
+double region_quadtree<key_t, value_t>::fraction(const quadrant_t* quadrant)
+{
+    if (isEmpty(quadrant->bound))
+        return 0;
+    return static_cast<double>(quadrant->count) / area(quadrant->bound);
+}
+
+/**
+ * @brief Interleave the bits of the coordinates, x in the even bits
+ */
+template<typename key_t, typename value_t>
+uint64_t region_quadtree<key_t, value_t>::morton_code(uint32_t x, uint32_t y)
+{
+    auto spread = [](uint64_t value)
+    {
+        value = (value | (value << 16)) & 0x0000ffff0000ffffULL;
+        value = (value | (value << 8)) & 0x00ff00ff00ff00ffULL;
+        value = (value | (value << 4)) & 0x0f0f0f0f0f0f0f0fULL;
+        value = (value | (value << 2)) & 0x3333333333333333ULL;
+        value = (value | (value << 1)) & 0x5555555555555555ULL;
+        return value;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+/**
+ * @brief Recursive method for changes_since
+ * @param quadrant Quadrant to look into
+ * @param epoch Epoch of the checkpoint
+ * @param[out] changed Blocks of changed cells
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::changes_quadrant(const quadrant_t*
+        quadrant, size_t epoch, vector<rect_t>& changed) const
+{
+    if (quadrant->epoch <= epoch || isEmpty(quadrant->bound))
+        return;
+    if (quadrant->isLeaf())
+    {
+        push_rect(quadrant->bound, changed);
+        return;
+    }
+    for (const quadrant_t* child : quadrant->children)
+        changes_quadrant(child, epoch, changed);
+}
+
+/**
+ * @brief Recursive method for region_diff
+ *
+ * @param quadrant Quadrant of one tree
+ * @param other_quadrant Quadrant of the other tree with the same bounds,
+ * null if the other tree is uniform there
+ * @param other_value Value of the other tree when other_quadrant is null
+ * @param[out] changed Blocks of cells with different values
+ * @return Number of cells with different values
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::region_diff_quadrant(
+    const quadrant_t* quadrant, const quadrant_t* other_quadrant,
+    const value_t& other_value, vector<rect_t>& changed) const
+{
+    if (isEmpty(quadrant->bound))
+        return 0;
+    if (quadrant->isLeaf() && other_quadrant && !other_quadrant->isLeaf())
+    {
+        // Uniform side: compare it with the leaves of the other side
+        return region_diff_quadrant(other_quadrant, nullptr, quadrant->data,
+                                    changed);
+    }
+    if (quadrant->isLeaf())
+    {
+        const value_t& value = other_quadrant ? other_quadrant->data :
+                               other_value;
+        if (quadrant->data == value)
+            return 0;
+        push_rect(quadrant->bound, changed);
+        return area(quadrant->bound);
+    }
+
+    size_t count = 0;
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        const quadrant_t* other_child = nullptr;
+        const value_t* value = &other_value;
+        if (other_quadrant && other_quadrant->isLeaf())
+            value = &other_quadrant->data;
+        else if (other_quadrant)
+            other_child = other_quadrant->children[i];
+        count += region_diff_quadrant(quadrant->children[i], other_child,
+                                      *value, changed);
+    }
+    return count;
+}
+
+/**
+ * @brief Add the bounds at the end of the blocks
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::push_rect(const rect_bound_t& bound,
+        vector<rect_t>& rects)
+{
+    rect_t rect;
+    rect.left = bound.left;
+    rect.bottom = bound.bottom;
+    rect.right = bound.right;
+    rect.top = bound.top;
+    rects.push_back(rect);
+}
+
+/**
+ * @brief Find the neighbour of the quadrant, at the same level or above
+ *
+ * Go up until the quadrant is not on the given side of its parent, then go
+ * down the mirrored path (Samet's neighbour finding).
+ *
+ * @param quadrant Quadrant to start from
+ * @param direction Side of the neighbour
+ * @return Neighbour not smaller than the quadrant, null on the border of
+ * the tree
+ */
+template<typename key_t, typename value_t>
+const typename region_quadtree<key_t, value_t>::quadrant_t*
+region_quadtree<key_t, value_t>::equal_neighbour(const quadrant_t* quadrant,
+                                        direction_t direction) const
+{
+    if (!quadrant->parent)
+        return nullptr;
+    uint8_t index = child_index(quadrant);
+    uint8_t bit = direction < direction_south ? quadrant_se : quadrant_nw;
+    bool positive = direction & 1;
+    if (((index & bit) != 0) != positive)
+    {
+        const quadrant_t* sibling = quadrant->parent->children[index ^ bit];
+        // A sibling without any cell is skipped
+        if (!isEmpty(sibling->bound))
+            return sibling;
+    }
+    const quadrant_t* neighbour = equal_neighbour(quadrant->parent, direction);
+    if (!neighbour || neighbour->isLeaf())
+        return neighbour;
+    const quadrant_t* child = neighbour->children[positive ? index & ~bit :
+                              index | bit];
+    return isEmpty(child->bound) ? neighbour : child;
+}
+
+/**
+ * @brief List the leaves sharing a side with the quadrant
+ * @param quadrant Quadrant to look around
+ * @param direction Side to look at
+ * @param[out] leaves Neighbour leaves, appended
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::neighbour_leaves(const quadrant_t* quadrant,
+        direction_t direction, vector<const quadrant_t*>& leaves) const
+{
+    const quadrant_t* neighbour = equal_neighbour(quadrant, direction);
+    if (neighbour)
+        side_leaves(neighbour, static_cast<direction_t>(direction ^ 1),
+                    quadrant->bound, leaves);
+}
+
+/**
+ * @brief List the leaves of the quadrant along its side, facing the bounds
+ * @param quadrant Quadrant to look into
+ * @param side Side of the quadrant
+ * @param facing Bounds on the other side
+ * @param[out] leaves Leaves found, appended
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::side_leaves(const quadrant_t* quadrant,
+        direction_t side, const rect_bound_t& facing,
+        vector<const quadrant_t*>& leaves) const
+{
+    const rect_bound_t& bound = quadrant->bound;
+    if (isEmpty(bound))
+        return;
+    // Only the quadrants overlapping the facing side are kept
+    if (side < direction_south ? bound.top <= facing.bottom ||
+            bound.bottom >= facing.top : bound.right <= facing.left ||
+            bound.left >= facing.right)
+        return;
+    if (quadrant->isLeaf())
+    {
+        leaves.push_back(quadrant);
+        return;
+    }
+    const rect_bound_t& parent = quadrant->bound;
+    for (const quadrant_t* child : quadrant->children)
+    {
+        bool on_side = false;
+        switch (side)
+        {
+        case direction_west:
+            on_side = child->bound.left == parent.left;
+            break;
+        case direction_east:
+            on_side = child->bound.right == parent.right;
+            break;
+        case direction_south:
+            on_side = child->bound.bottom == parent.bottom;
+            break;
+        case direction_north:
+            on_side = child->bound.top == parent.top;
+            break;
+        }
+        if (on_side)
+            side_leaves(child, side, facing, leaves);
+    }
+}
+
+/**
+ * @brief Find the leaf containing the cell
+ * @param x X coordinate of the cell
+ * @param y Y coordinate of the cell
+ * @return Return the leaf, null outside of the tree
+ */
+template<typename key_t, typename value_t>
+const typename region_quadtree<key_t, value_t>::quadrant_t*
+region_quadtree<key_t, value_t>::leaf_at(key_t x, key_t y) const
+{
+    const quadrant_t* quadrant = this->m_root;
+    if (!quadrant || !quadrant->bound.isInside(x, y))
+        return nullptr;
+    while (!quadrant->isLeaf())
+        quadrant = quadrant->children[quadrant->bound.childIndex(x, y)];
+    return quadrant;
+}
+
+/**
+ * @brief List the leaves with the given value
+ * @param quadrant Quadrant to look into
+ * @param item Value of the leaves
+ * @param[out] leaves Leaves found, appended
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::collect_leaves(const quadrant_t* quadrant,
+        const value_t& item, vector<const quadrant_t*>& leaves) const
+{
+    if (isEmpty(quadrant->bound))
+        return;
+    if (!quadrant->isLeaf())
+    {
+        for (const quadrant_t* child : quadrant->children)
+            collect_leaves(child, item, leaves);
+    }
+    else if (quadrant->data == item)
+    {
+        leaves.push_back(quadrant);
+    }
+}
+
+/**
+ * @brief Index of the quadrant in the children of its parent
+ */
+template<typename key_t, typename value_t>
+uint8_t region_quadtree<key_t, value_t>::child_index(const quadrant_t* quadrant)
+{
+    uint8_t index = 0;
+    while (quadrant->parent->children[index] != quadrant)
+        index++;
+    return index;
+}
+
+/**
+ * @brief Number of cells covered by the bounds
+ */
+template<typename key_t, typename value_t>
+size_t region_quadtree<key_t, value_t>::area(const rect_bound_t& bound)
+{
+    return static_cast<size_t>((bound.right - bound.left) *
+                               (bound.top - bound.bottom));
+}
+
+/**
+ * @brief Tells if the bounds do not cover any cell
+ *
+ * Happens to the children of a quadrant one cell wide.
+ */
+template<typename key_t, typename value_t>
+bool region_quadtree<key_t, value_t>::isEmpty(const rect_bound_t& bound)
+{
+    return !(bound.left < bound.right) || !(bound.bottom < bound.top);
+}
+
+/**
+ * @brief Tells if the value is the zero of its type
+ */
+template<typename key_t, typename value_t>
+bool region_quadtree<key_t, value_t>::isZero(const value_t& value)
+{
+    return value == value_t();
+}
+
+/**
+ * @brief Recursive method for encode
+ * @param quadrant Quadrant to write
+ * @param writer Destination of the bits
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::encode_quadrant(const quadrant_t*
+        quadrant, bit_writer_t& writer) const
+{
+    if (isEmpty(quadrant->bound))
+        return;
+    writer.write(!quadrant->isLeaf());
+    if (quadrant->isLeaf())
+    {
+        write_value(quadrant->data, writer);
+        return;
+    }
+    for (const quadrant_t* child : quadrant->children)
+        encode_quadrant(child, writer);
+}
+
+/**
+ * @brief Recursive method for decode
+ * @param quadrant Leaf to build
+ * @param reader Source of the bits
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::decode_quadrant(quadrant_t* quadrant,
+        bit_reader_t& reader)
+{
+    if (isEmpty(quadrant->bound))
+        return;
+    if (reader.read())
+    {
+        // A unit cell has a child as large as itself, which never ends
+        if (!this->can_split(quadrant))
+            throw epstl::value_exception("The encoding is too deep");
+        split_leaf(quadrant);
+        size_t count = 0;
+        for (quadrant_t* child : quadrant->children)
+        {
+            decode_quadrant(child, reader);
+            count += child->count;
+        }
+        quadrant->count = count;
+        return;
+    }
+    assign_quadrant(quadrant, read_value(reader));
+}
+
+/**
+ * @brief Write the bits of the value
+ */
+template<typename key_t, typename value_t>
+void region_quadtree<key_t, value_t>::write_value(const value_t& value,
+        bit_writer_t& writer)
+{
+    if constexpr (std::is_same<value_t, bool>::value)
+    {
+        writer.write(value);
+    }
+    else
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(value_t); i++)
+            for (uint8_t bit = 0; bit < 8; bit++)
+                writer.write((bytes[i] >> bit) & 1);
+    }
+}
+
+/**
+ * @brief Read the bits of a value written by write_value
+ */
+template<typename key_t, typename value_t>
+value_t region_quadtree<key_t, value_t>::read_value(bit_reader_t& reader)
+{
+    if constexpr (std::is_same<value_t, bool>::value)
+    {
+        return reader.read();
+    }
+    else
+    {
+        value_t value;
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&value);
+        for (size_t i = 0; i < sizeof(value_t); i++)
+        {
+            bytes[i] = 0;
+            for (uint8_t bit = 0; bit < 8; bit++)
+                bytes[i] |= static_cast<uint8_t>(reader.read()) << bit;
+        }
+        return value;
+    }
+}
+
+/**
+ * @brief Get the value at the given position
+ *
+ * Return the default value if there is nothing at the given coordinates
+ * @param quadrant Quadrant to look into
+ * @param x X coordinate to look for
+ * @param y Y coordinate to look for
+ * @return Constant reference on the value
+ */
+template<typename key_t, typename value_t>
+const value_t& region_quadtree<key_t, value_t>::get_value(quadrant_t* quadrant,
+        key_t x, key_t y) const
+{
+    if (!quadrant || !quadrant->bound.isInside(x, y))
+        return this->m_default_value;
+    if (!quadrant->isLeaf())
+    {
+        auto** selected_quadrant = this->select_quadrant(quadrant, x, y);
+        if (!selected_quadrant)
+            return this->m_default_value;
+        return get_value(*selected_quadrant, x, y);
+    }
+    else
+    {
+        return quadrant->data;
+    }
+}
+
+/**
+ * @brief Get the value at the given position
+ *
+ * Return the default value if there is nothing at the given coordinates
+ *
+ * @warning Need to set m_exposed_default_value before calling the method
+ *
+ * @param quadrant Quadrant to look into
+ * @param x X coordinate to look for
+ * @param y Y coordinate to look for
+ * @return Mutable reference on the value
+ */
+template<typename key_t, typename value_t>
+value_t&
+region_quadtree<key_t, value_t>::get_value(quadrant_t* quadrant, key_t x,
+        key_t y)
+{
+    if (!quadrant || !quadrant->bound.isInside(x, y))
+        return this->m_exposed_default_value;
+    if (!quadrant->isLeaf())
+    {
+        auto** selected_quadrant = this->select_quadrant(quadrant, x, y);
+        if (!selected_quadrant)
+            return this->m_exposed_default_value;
+        return get_value(*selected_quadrant, x, y);
+    }
+    else
+    {
+        return quadrant->data;
+    }
+}
+
+
+} // namespace epstl
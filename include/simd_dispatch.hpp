@@ -0,0 +1,101 @@
+#pragma once
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EPSTL_SIMD_DISPATCH
+/// Kernel inlined in each copy of simd_dispatch
+#define EPSTL_SIMD_KERNEL __attribute__((always_inline)) inline
+#define EPSTL_RESTRICT __restrict__
+/// Loop on a block, vectorized rather than unrolled at -O3
+#define EPSTL_SIMD_BLOCK _Pragma("GCC unroll 1")
+#else
+#define EPSTL_SIMD_KERNEL inline
+#define EPSTL_RESTRICT
+#define EPSTL_SIMD_BLOCK
+#endif
+
+namespace epstl
+{
+
+/**
+ * @brief Widest vector instructions usable by the kernels
+ */
+enum simd_level_t
+{
+    simd_default,   ///< Instructions enabled at compile time (SSE2 on x86-64)
+    simd_avx2,      ///< AVX2 and FMA, 256 bits
+    simd_avx512     ///< AVX-512F, 512 bits
+};
+
+/**
+ * @brief Instructions supported by the CPU, detected once
+ */
+inline simd_level_t simd_level()
+{
+#ifdef EPSTL_SIMD_DISPATCH
+    static const simd_level_t level = []()
+    {
+        if (__builtin_cpu_supports("avx512f"))
+            return simd_avx512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return simd_avx2;
+        return simd_default;
+    }();
+    return level;
+#else
+    return simd_default;
+#endif
+}
+
+#ifdef EPSTL_SIMD_DISPATCH
+/**
+ * @brief Compile the kernel for AVX2 and FMA
+ *
+ * The kernel is inlined here, so its loops are vectorized for the target.
+ */
+template<auto kernel, typename... args_t>
+__attribute__((target("avx2,fma"))) auto simd_run_avx2(args_t... args)
+{
+    return kernel(args...);
+}
+
+/**
+ * @brief Compile the kernel for AVX-512F
+ */
+template<auto kernel, typename... args_t>
+__attribute__((target("avx512f"))) auto simd_run_avx512(args_t... args)
+{
+    return kernel(args...);
+}
+#endif
+
+/**
+ * @brief Run the kernel compiled for the widest instructions of the CPU
+ *
+ * The kernel is a function marked with EPSTL_SIMD_KERNEL, written as plain
+ * loops of constant length (EPSTL_SIMD_BLOCK) on restrict pointers: the
+ * compiler vectorizes one copy of it for each instruction set and the copy
+ * is chosen at runtime. Without the GCC target attributes, the kernel is
+ * called as is.
+ *
+ * @param args Arguments of the kernel
+ * @return Return the result of the kernel
+ */
+template<auto kernel, typename... args_t>
+auto simd_dispatch(args_t... args)
+{
+#ifdef EPSTL_SIMD_DISPATCH
+    switch (simd_level())
+    {
+    case simd_avx512:
+        return simd_run_avx512<kernel>(args...);
+    case simd_avx2:
+        return simd_run_avx2<kernel>(args...);
+    default:
+        break;
+    }
+#endif
+    return kernel(args...);
+}
+
+} // namespace epstl
+
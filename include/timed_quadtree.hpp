@@ -0,0 +1,373 @@
+#pragma once
+
+#include "quadtree.hpp"
+
+namespace epstl
+{
+
+/**
+ * @brief Point quadtree with timestamped items and fast expiry
+ *
+ * The items are stored in a ring of generation quadtrees, each generation
+ * covering a fixed span of time. Expiring the items older than a cutoff
+ * discards whole generations, only the generation containing the cutoff is
+ * filtered point by point. Items older than the ring are dropped when the
+ * ring moves forward.
+ *
+ * When several items are inserted at the same position in one generation,
+ * only the last one is kept.
+ *
+ * Example :
+ * @code
+ * // 20 by 20 tree, generations of 10 time units, 6 generations kept
+ * epstl::timed_quadtree<float, int> tree(0, 0, 20, 20, 10, 6);
+ *
+ * tree.insert(5, 5, 100, 12);
+ * tree.insert(3, 3, 110, 35);
+ * tree.at(5, 5); // returns 100
+ * tree.at(5, 5, 20, 40); // returns the default value, 100 is too old
+ *
+ * tree.expire(30); // Drop the item at 5,5
+ * @endcode
+ */
+template<typename key_t, typename item_t, typename timestamp_t = uint64_t>
+class timed_quadtree : public container
+{
+  protected:
+    /**
+     * @brief Item stored in the generation trees
+     */
+    struct timed_item_t
+    {
+        item_t item{};
+        timestamp_t timestamp = 0;
+
+        bool operator==(const timed_item_t& other) const
+        {
+            return item == other.item && timestamp == other.timestamp;
+        }
+
+        friend std::ostream& operator<<(std::ostream& stream,
+                                        const timed_item_t& timed_item)
+        {
+            return stream << timed_item.item << " @" << timed_item.timestamp;
+        }
+    };
+
+    typedef quadtree<key_t, timed_item_t> generation_tree_t;
+
+    /**
+     * @brief Slot of the generation ring
+     */
+    struct generation_t
+    {
+        timestamp_t index = 0;              ///< Generation number
+        generation_tree_t* tree = nullptr;  ///< Items of the generation
+    };
+
+  public:
+    /**
+     * @brief Construct a timed quadtree with the given center and width/height
+     * @param center_x X coordinate of the center
+     * @param center_y Y coordinate of the center
+     * @param width Width of the root
+     * @param height Height of the root
+     * @param generation_span Time covered by one generation
+     * @param generation_count Number of generations kept
+     */
+    explicit timed_quadtree(key_t center_x, key_t center_y, key_t width,
+                            key_t height, timestamp_t generation_span,
+                            size_t generation_count) :
+        m_center_x(center_x), m_center_y(center_y), m_width(width),
+        m_height(height), m_generation_span(generation_span),
+        m_generation_count(generation_count)
+    {
+        if (generation_span <= 0 || generation_count == 0)
+            throw epstl::value_exception("The generation span and count need to be positive");
+        m_generations = new generation_t[m_generation_count];
+    }
+
+    timed_quadtree(const timed_quadtree& copy) = delete;
+    timed_quadtree& operator=(const timed_quadtree& copy) = delete;
+    ~timed_quadtree() override;
+
+    /**
+     * @brief Get the number of items stored (not expired)
+     */
+    size_t size() const noexcept override
+    {
+        return m_size;
+    }
+
+    /**
+     * @brief Get the cutoff of the last expiry
+     *
+     * Items older than the cutoff are not stored anymore.
+     */
+    timestamp_t cutoff() const noexcept
+    {
+        return m_cutoff;
+    }
+
+    /**
+     * @brief Get the default value of the items
+     */
+    const item_t& default_value() const noexcept
+    {
+        return m_default_value;
+    }
+
+    size_t insert(key_t x, key_t y, const item_t& item, timestamp_t timestamp);
+
+    const item_t& at(key_t x, key_t y) const;
+    const item_t& at(key_t x, key_t y, timestamp_t from, timestamp_t to) const;
+
+    bool find(const item_t& item, epstl::pair<key_t>& keys, timestamp_t from,
+              timestamp_t to) const;
+
+    void expire(timestamp_t cutoff);
+
+  protected:
+    generation_t* generation(timestamp_t index) const;
+    void drop_generation(generation_t& generation);
+
+    key_t m_center_x;                   ///< X coordinate of the center
+    key_t m_center_y;                   ///< Y coordinate of the center
+    key_t m_width;                      ///< Width of the root quadrant
+    key_t m_height;                     ///< Height of the root quadrant
+    timestamp_t m_generation_span;      ///< Time covered by a generation
+    size_t m_generation_count;          ///< Number of slots in the ring
+    generation_t* m_generations = nullptr; ///< Ring of generations
+    timestamp_t m_newest = 0;           ///< Index of the newest generation
+    timestamp_t m_cutoff = 0;           ///< Items older are expired
+    size_t m_size = 0;                  ///< Number of items stored
+    item_t m_default_value{};           ///< Default value of the items
+};
+
+/**
+ * @brief Destructor
+ *
+ * Free all the generation trees
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+timed_quadtree<key_t, item_t, timestamp_t>::~timed_quadtree()
+{
+    for (size_t i = 0; i < m_generation_count; i++)
+        delete m_generations[i].tree;
+    delete[] m_generations;
+}
+
+/**
+ * @brief Insert the item at the given coordinates with its timestamp
+ *
+ * Moving to a newer generation drops the generations falling out of the
+ * ring. Items older than the ring or than the cutoff are ignored.
+ *
+ * @param x X coordinate of the item
+ * @param y Y coordinate of the item
+ * @param item Item to copy in the tree
+ * @param timestamp Time of the item
+ * @return Number of items stored
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+size_t timed_quadtree<key_t, item_t, timestamp_t>::insert(key_t x, key_t y,
+        const item_t& item, timestamp_t timestamp)
+{
+    if (timestamp < m_cutoff)
+        return m_size;
+    timestamp_t index = timestamp / m_generation_span;
+    if (index > m_newest)
+    {
+        // Drop the generations reused by the new ones
+        for (size_t i = 0; i < m_generation_count; i++)
+        {
+            if (m_generations[i].tree &&
+                    m_generations[i].index + m_generation_count <= index)
+                drop_generation(m_generations[i]);
+        }
+        m_newest = index;
+    }
+    else if (index + m_generation_count <= m_newest)
+    {
+        return m_size;
+    }
+
+    generation_t& slot = m_generations[index % m_generation_count];
+    if (!slot.tree)
+    {
+        slot.index = index;
+        slot.tree = new generation_tree_t(m_center_x, m_center_y, m_width,
+                                          m_height);
+    }
+    m_size -= slot.tree->size();
+    timed_item_t timed_item;
+    timed_item.item = item;
+    timed_item.timestamp = timestamp;
+    slot.tree->insert(x, y, timed_item);
+    m_size += slot.tree->size();
+    return m_size;
+}
+
+/**
+ * @brief Get the newest item at the given coordinates
+ *
+ * If there is no item at the given coordinates, the default value is
+ * returned.
+ *
+ * @param x X coordinate to get
+ * @param y Y coordinate to get
+ * @return Constant reference on the value
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+const item_t& timed_quadtree<key_t, item_t, timestamp_t>::at(key_t x,
+        key_t y) const
+{
+    return at(x, y, m_cutoff, (m_newest + 1) * m_generation_span);
+}
+
+/**
+ * @brief Get the newest item at the given coordinates, inserted in the window
+ *
+ * Only the generations overlapping the window are looked into.
+ *
+ * @param x X coordinate to get
+ * @param y Y coordinate to get
+ * @param from Start of the time window (included)
+ * @param to End of the time window (included)
+ * @return Constant reference on the value, or on the default value
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+const item_t& timed_quadtree<key_t, item_t, timestamp_t>::at(key_t x, key_t y,
+        timestamp_t from, timestamp_t to) const
+{
+    if (to < from)
+        return m_default_value;
+    timestamp_t first = from / m_generation_span;
+    timestamp_t last = to / m_generation_span;
+    if (last > m_newest)
+        last = m_newest;
+    for (timestamp_t index = last + 1; index-- > first;)
+    {
+        generation_t* slot = generation(index);
+        if (!slot)
+        {
+            if (index + m_generation_count <= m_newest)
+                break;
+            continue;
+        }
+        const timed_item_t& timed_item = slot->tree->at(x, y);
+        if (!(timed_item == slot->tree->default_value()) &&
+                timed_item.timestamp >= from && timed_item.timestamp <= to)
+            return timed_item.item;
+    }
+    return m_default_value;
+}
+
+/**
+ * @brief Find the item inserted in the time window
+ *
+ * @param item Item to look for
+ * @param[out] keys Output containing the coordinates of the item, if it was found.
+ * @param from Start of the time window (included)
+ * @param to End of the time window (included)
+ * @return Return true if the item was found
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+bool timed_quadtree<key_t, item_t, timestamp_t>::find(const item_t& item,
+        epstl::pair<key_t>& keys, timestamp_t from, timestamp_t to) const
+{
+    if (to < from)
+        return false;
+    timed_item_t searched;
+    searched.item = item;
+    auto criterion = [from, to](const timed_item_t & i1,
+                                const timed_item_t & i2)
+    {
+        return i1.item == i2.item && i1.timestamp >= from && i1.timestamp <= to;
+    };
+
+    timestamp_t first = from / m_generation_span;
+    timestamp_t last = to / m_generation_span;
+    if (last > m_newest)
+        last = m_newest;
+    for (timestamp_t index = last + 1; index-- > first;)
+    {
+        generation_t* slot = generation(index);
+        if (!slot)
+        {
+            if (index + m_generation_count <= m_newest)
+                break;
+            continue;
+        }
+        if (slot->tree->find(searched, keys, criterion))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Drop all the items older than the cutoff
+ *
+ * The generations ending before the cutoff are discarded at once, the
+ * generation containing the cutoff is filtered.
+ *
+ * @param cutoff Items with a timestamp strictly lower are dropped
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+void timed_quadtree<key_t, item_t, timestamp_t>::expire(timestamp_t cutoff)
+{
+    if (cutoff <= m_cutoff)
+        return;
+    m_cutoff = cutoff;
+    timestamp_t cutoff_index = cutoff / m_generation_span;
+    for (size_t i = 0; i < m_generation_count; i++)
+    {
+        generation_t& slot = m_generations[i];
+        if (!slot.tree)
+            continue;
+        if (slot.index < cutoff_index)
+        {
+            drop_generation(slot);
+        }
+        else if (slot.index == cutoff_index)
+        {
+            auto older = [cutoff](const timed_item_t & i1, const timed_item_t&)
+            {
+                return i1.timestamp < cutoff;
+            };
+            m_size -= slot.tree->size();
+            slot.tree->remove_all(timed_item_t{}, older);
+            m_size += slot.tree->size();
+        }
+    }
+}
+
+/**
+ * @brief Get the slot holding the given generation
+ * @param index Generation number
+ * @return Pointer on the slot, null if the generation is not stored
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+typename timed_quadtree<key_t, item_t, timestamp_t>::generation_t*
+timed_quadtree<key_t, item_t, timestamp_t>::generation(timestamp_t index) const
+{
+    generation_t& slot = m_generations[index % m_generation_count];
+    if (slot.tree && slot.index == index)
+        return &slot;
+    return nullptr;
+}
+
+/**
+ * @brief Discard the whole generation
+ * @param generation Slot to empty
+ */
+template<typename key_t, typename item_t, typename timestamp_t>
+void timed_quadtree<key_t, item_t, timestamp_t>::drop_generation(
+    generation_t& generation)
+{
+    m_size -= generation.tree->size();
+    delete generation.tree;
+    generation.tree = nullptr;
+}
+
+} // namespace epstl
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <initializer_list>
+#include <utility>
 
 #ifdef USE_CUSTOM_STL
 namespace epstl
@@ -67,8 +68,13 @@ class vector : public linear_container<T>
     vector() = default;
 
     vector(std::initializer_list<T> list);
+    vector(const vector& copy);
+    vector(vector&& move) noexcept;
     ~vector() override;
 
+    vector& operator=(const vector& copy);
+    vector& operator=(vector&& move) noexcept;
+
     epstl::size_t push_back(T e) override;
     epstl::size_t pop_back() override;
 
@@ -93,7 +99,7 @@ class vector : public linear_container<T>
      */
     const T& operator[](int index) const
     {
-        m_data[index];
+        return m_data[index];
     }
 
     /**
@@ -106,7 +112,7 @@ class vector : public linear_container<T>
      */
     T& operator[](int index)
     {
-        m_data[index];
+        return m_data[index];
     }
 
     /**
@@ -215,6 +221,64 @@ vector<T, ALLOCATION_BATCH>::vector(std::initializer_list<T> list)
     }
 }
 
+/**
+ * @brief Copy constructor
+ */
+template<typename T, epstl::size_t ALLOCATION_BATCH>
+vector<T, ALLOCATION_BATCH>::vector(const vector& copy) :
+    m_allocated(copy.m_allocated), m_size(copy.m_size)
+{
+    if (m_allocated == 0)
+        return;
+    m_data = new T[m_allocated];
+    for (epstl::size_t i = 0; i < m_size; i++)
+        m_data[i] = copy.m_data[i];
+}
+
+/**
+ * @brief Move constructor
+ */
+template<typename T, epstl::size_t ALLOCATION_BATCH>
+vector<T, ALLOCATION_BATCH>::vector(vector&& move) noexcept :
+    m_allocated(move.m_allocated), m_size(move.m_size), m_data(move.m_data)
+{
+    move.m_allocated = 0;
+    move.m_size = 0;
+    move.m_data = nullptr;
+}
+
+/**
+ * @brief Assignation operator
+ */
+template<typename T, epstl::size_t ALLOCATION_BATCH>
+vector<T, ALLOCATION_BATCH>& vector<T, ALLOCATION_BATCH>::operator=(
+    const vector& copy)
+{
+    if (this == &copy)
+        return *this;
+    vector tmp(copy);
+    return *this = std::move(tmp);
+}
+
+/**
+ * @brief Assignation operator with move
+ */
+template<typename T, epstl::size_t ALLOCATION_BATCH>
+vector<T, ALLOCATION_BATCH>& vector<T, ALLOCATION_BATCH>::operator=(
+    vector&& move) noexcept
+{
+    if (this == &move)
+        return *this;
+    delete[] m_data;
+    m_allocated = move.m_allocated;
+    m_size = move.m_size;
+    m_data = move.m_data;
+    move.m_allocated = 0;
+    move.m_size = 0;
+    move.m_data = nullptr;
+    return *this;
+}
+
 /**
  * @brief Destructor
  */
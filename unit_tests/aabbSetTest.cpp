@@ -0,0 +1,110 @@
+#include "aabbSetTest.hpp"
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace epstl
+{
+
+TEST_F(aabbSetTest, Storage)
+{
+    aabb_set<2, float> few;
+    AABB<2, float> first({0, 0}, {10, 10});
+    EXPECT_EQ(few.push_back(first), 1u);
+    EXPECT_EQ(few.push_back({{20, 0}, {30, 10}}), 2u);
+    EXPECT_TRUE(few[0] == first);
+    EXPECT_TRUE((few.bounds() == AABB<2, float>({0, 0}, {30, 10})));
+
+    few.set(1, {{-5, -5}, {1, 1}});
+    EXPECT_TRUE((few.bounds() == AABB<2, float>({-5, -5}, {10, 10})));
+    EXPECT_EQ(few.pop_back(), 1u);
+    EXPECT_TRUE(few.bounds() == first);
+
+    ASSERT_EQ(boxes.size(), box_count);
+    AABB<2, float> bounds = expected[0];
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        ASSERT_TRUE(boxes[i] == expected[i]);
+        bounds.expand(expected[i]);
+    }
+    EXPECT_TRUE(boxes.bounds() == bounds);
+    EXPECT_EQ(boxes.lows().capacity(), boxes.highs().capacity());
+}
+
+TEST_F(aabbSetTest, IntersectsAndContains)
+{
+    std::unique_ptr<bool[]> result(new bool[expected.size()]);
+
+    AABB<2, float> query({-20, -30}, {25, 10});
+    size_t expected_count = 0;
+    for (const auto& box : expected)
+        expected_count += box.intersects(query);
+    EXPECT_EQ(boxes.intersects(query, result.get()), expected_count);
+    for (size_t i = 0; i < expected.size(); i++)
+        ASSERT_EQ(result[i], expected[i].intersects(query));
+
+    Point<2, float> point = {5, -7};
+    expected_count = 0;
+    for (const auto& box : expected)
+        expected_count += box.contains(point);
+    EXPECT_EQ(boxes.contains(point, result.get()), expected_count);
+    for (size_t i = 0; i < expected.size(); i++)
+        ASSERT_EQ(result[i], expected[i].contains(point));
+}
+
+TEST_F(aabbSetTest, SquaredDistances)
+{
+
+    Point<2, float> point = {5, -7};
+    std::vector<float> distances(expected.size());
+    boxes.squared_distances(point, distances.data());
+    for (size_t i = 0; i < expected.size(); i++)
+        ASSERT_FLOAT_EQ(distances[i], expected[i].squared_distance(point));
+}
+
+TEST_F(aabbSetTest, Ray)
+{
+
+    // Ray along the diagonal, length of the direction is 1
+    Point<2, float> origin = {-100, -100};
+    Point<2, float> direction = {std::sqrt(0.5f), std::sqrt(0.5f)};
+    Point<2, float> inverse = {1 / direction[0], 1 / direction[1]};
+    std::vector<float> entries(expected.size());
+    size_t hits = boxes.intersects_ray(origin, direction, 150, entries.data());
+    size_t expected_count = 0;
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        float t_min = 0, t_max = 150;
+        if (expected[i].intersects_ray(origin, inverse, t_min, t_max))
+        {
+            ASSERT_FLOAT_EQ(entries[i], t_min);
+            expected_count++;
+        }
+        else
+        {
+            ASSERT_EQ(entries[i], std::numeric_limits<float>::infinity());
+        }
+    }
+    EXPECT_EQ(hits, expected_count);
+    EXPECT_GT(hits, 0u);
+}
+
+TEST_F(aabbSetTest, Empty)
+{
+    aabb_set<2, float> empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_TRUE(empty.bounds().isEmpty());
+    EXPECT_EQ(empty.intersects({{0, 0}, {1, 1}}, nullptr), 0u);
+    EXPECT_EQ(empty.intersects_ray({0, 0}, {1, 0}, 10, nullptr), 0u);
+
+    aabb_set<2, float> copy(empty);
+    EXPECT_EQ(copy.size(), 0u);
+    copy.push_back({{0, 0}, {1, 1}});
+    EXPECT_EQ(copy.size(), 1u);
+    copy = empty;
+    EXPECT_EQ(copy.size(), 0u);
+}
+
+} // namespace epstl
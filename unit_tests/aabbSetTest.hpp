@@ -0,0 +1,39 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <aabb_set.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+namespace epstl
+{
+
+class aabbSetTest : public ::testing::Test
+{
+  public:
+    /// aabb_set works on blocks of 16 boxes: 31 whole blocks, and a tail of
+    /// 4 boxes for the scalar loop
+    static constexpr size_t box_count = 31 * 16 + 4;
+
+    void SetUp() override
+    {
+        for (size_t i = 0; i < box_count; i++)
+        {
+            Point<2, float> low = {std::rand() % 200 - 100.f,
+                                   std::rand() % 200 - 100.f
+                                  };
+            Point<2, float> size = {float(std::rand() % 20),
+                                    float(std::rand() % 20)
+                                   };
+            expected.push_back(AABB<2, float>(low, low + size));
+            boxes.push_back(expected.back());
+        }
+    }
+
+    aabb_set<2, float> boxes;               ///< Random boxes
+    std::vector<AABB<2, float>> expected;   ///< Same boxes, one by one
+};
+
+} // namespace epstl
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <distance_field.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+namespace epstl
+{
+
+TEST(distanceFieldTest, IncrementalUpdates)
+{
+    const int width = 40;
+    const int height = 30;
+    const double max_distance = 6.5;
+    distance_field<int> field(width, height, max_distance);
+    std::vector<std::pair<int, int>> set_cells;
+
+    auto check = [&]()
+    {
+        for (int y = -height / 2; y < height / 2; y++)
+        {
+            for (int x = -width / 2; x < width / 2; x++)
+            {
+                double expected = max_distance;
+                for (const auto& cell : set_cells)
+                    expected = std::min(expected, std::hypot(cell.first - x,
+                                        cell.second - y));
+                ASSERT_DOUBLE_EQ(field.distance(x, y), expected);
+            }
+        }
+    };
+
+    for (int i = 0; i < 30; i++)
+    {
+        int x = std::rand() % width - width / 2;
+        int y = std::rand() % height - height / 2;
+        field.set(x, y);
+        if (std::find(set_cells.begin(), set_cells.end(),
+                      std::make_pair(x, y)) == set_cells.end())
+            set_cells.push_back({x, y});
+    }
+    check();
+
+    for (int i = 0; i < 20; i++)
+    {
+        size_t removed = std::rand() % set_cells.size();
+        field.unset(set_cells[removed].first, set_cells[removed].second);
+        set_cells.erase(set_cells.begin() + removed);
+    }
+    check();
+    EXPECT_EQ(field.region().size(), set_cells.size());
+
+    int nearest_x, nearest_y;
+    field.set(0, 0);
+    EXPECT_TRUE(field.nearest(1, 1, nearest_x, nearest_y));
+    EXPECT_DOUBLE_EQ(std::hypot(nearest_x - 1, nearest_y - 1),
+                     field.distance(1, 1));
+    EXPECT_EQ(field.distance(100, 100), max_distance);
+    EXPECT_THROW(distance_field<int>(10, 10, -1), value_exception);
+    EXPECT_THROW(distance_field<int>(10, 10,
+                                     std::numeric_limits<double>::infinity()),
+                 value_exception);
+
+    // Distance larger than the keys: the update stops at the map
+    distance_field<int> far_field(8, 8, 1e12);
+    far_field.set(3, 3);
+    EXPECT_DOUBLE_EQ(far_field.distance(-4, -4), std::hypot(7, 7));
+    far_field.unset(3, 3);
+    EXPECT_EQ(far_field.distance(-4, -4), 1e12);
+
+    // Only the cells around the set cells are stored, not the whole map
+    distance_field<int> large(60000, 60000, 3);
+    large.set(1000, -2000);
+    EXPECT_DOUBLE_EQ(large.distance(1002, -2001), std::hypot(2, 1));
+    EXPECT_EQ(large.distance(0, 0), 3);
+}
+
+} // namespace epstl
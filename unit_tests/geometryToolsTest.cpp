@@ -2,6 +2,11 @@
 
 #include <geometry_tools.hpp>
 
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
 namespace epstl
 {
 
@@ -14,4 +19,131 @@ TEST(geometryToolsTest, PointInitializerList)
     EXPECT_EQ(pt.size(), 3);
 }
 
+TEST(geometryToolsTest, PointArithmetic)
+{
+    constexpr Point<3> a{1, 2, 3};
+    constexpr Point<3> b{4, 5, 6};
+    static_assert((a + 2 * b)[2] == 15, "Constant expression");
+    static_assert(a.dot(b) == 32, "Constant expression");
+
+    EXPECT_EQ(a + b, (Point<3> {5, 7, 9}));
+    EXPECT_EQ(b - a, (Point<3> {3, 3, 3}));
+    EXPECT_EQ(a * b, (Point<3> {4, 10, 18}));
+    EXPECT_EQ(b / a, (Point<3> {4, 2.5, 2}));
+    EXPECT_EQ(-a, (Point<3> {-1, -2, -3}));
+    EXPECT_EQ(a / 2, (Point<3> {0.5, 1, 1.5}));
+    EXPECT_EQ(dot(a, b), 32);
+    EXPECT_EQ(squared_distance(a, b), 27);
+    EXPECT_DOUBLE_EQ(distance(a, b), std::sqrt(27));
+    EXPECT_DOUBLE_EQ((Point<2> {3, 4}).norm(), 5);
+    EXPECT_EQ(lerp(a, b, 0.5), (Point<3> {2.5, 3.5, 4.5}));
+
+    Point<4, float> low{0, 0, 0, 0};
+    Point<4, float> high{1, 1, 1, 1};
+    Point<4, float> point{-1, 0.5, 2, 1};
+    EXPECT_EQ(min(point, high), (Point<4, float> {-1, 0.5, 1, 1}));
+    EXPECT_EQ(max(point, low), (Point<4, float> {0, 0.5, 2, 1}));
+    EXPECT_EQ(clamp(point, low, high), (Point<4, float> {0, 0.5, 1, 1}));
+    EXPECT_EQ(alignof(Point<4, float>), 16);
+
+    // The missing coordinates are 0
+    Point<3> partial{1};
+    EXPECT_EQ(partial, (Point<3> {1, 0, 0}));
+    EXPECT_THROW((Point<2> {1, 2, 3}), value_exception);
+}
+
+TEST(geometryToolsTest, PointsInPolygon)
+{
+    // Five-pointed star: the center is wound twice
+    const double star[] = {0, 3, 2, -3, -3, 1, 3, 1, -2, -3};
+    const double xs[] = {0, 0, 2.9, 10, 0.5};
+    const double ys[] = {0, 2, 0.5, 0, -3};
+    bool inside[5];
+
+    EXPECT_EQ(points_in_polygon(star, 5, xs, ys, 5, inside), 1);
+    EXPECT_FALSE(inside[0]);
+    EXPECT_TRUE(inside[1]);
+    EXPECT_FALSE(inside[2]);
+    EXPECT_FALSE(inside[3]);
+    EXPECT_FALSE(inside[4]);
+
+    EXPECT_EQ(points_in_polygon(star, 5, xs, ys, 5, inside, fill_non_zero), 2);
+    EXPECT_TRUE(inside[0]);
+    EXPECT_TRUE(inside[1]);
+
+    // Left and bottom edges are inside, right and top edges are outside
+    const int square[] = {0, 0, 4, 0, 4, 4, 0, 4};
+    EXPECT_TRUE(point_in_polygon(square, 4, 0, 2));
+    EXPECT_TRUE(point_in_polygon(square, 4, 2, 0));
+    EXPECT_FALSE(point_in_polygon(square, 4, 4, 2));
+    EXPECT_FALSE(point_in_polygon(square, 4, 2, 4));
+
+    // Batches larger than a block match the point by point test
+    std::vector<double> grid_xs, grid_ys;
+    for (double y = -4; y < 4; y += 0.25)
+    {
+        for (double x = -4; x < 4; x += 0.25)
+        {
+            grid_xs.push_back(x);
+            grid_ys.push_back(y);
+        }
+    }
+    std::unique_ptr<bool[]> batch(new bool[grid_xs.size()]);
+    points_in_polygon(star, 5, grid_xs.data(), grid_ys.data(), grid_xs.size(),
+                      batch.get(), fill_non_zero);
+    for (size_t i = 0; i < grid_xs.size(); i++)
+        EXPECT_EQ(batch[i], point_in_polygon(star, 5, grid_xs[i], grid_ys[i],
+                                             fill_non_zero));
+}
+
+
+TEST(geometryToolsTest, AABB)
+{
+    AABB<2> box({0, 0}, {10, 5});
+    EXPECT_FALSE(box.isEmpty());
+    EXPECT_TRUE(box.contains({10, 5}));
+    EXPECT_FALSE(box.contains({10.5, 5}));
+    EXPECT_TRUE(box.contains(AABB<2>({1, 1}, {2, 2})));
+    EXPECT_TRUE(box.contains(AABB<2>()));
+    EXPECT_TRUE(box.intersects(AABB<2>({10, 5}, {12, 8})));
+    EXPECT_FALSE(box.intersects(AABB<2>({11, 0}, {12, 8})));
+    EXPECT_DOUBLE_EQ(box.squared_distance({13, 9}), 25);
+    EXPECT_DOUBLE_EQ(box.distance({5, -2}), 2);
+    EXPECT_DOUBLE_EQ(box.distance({5, 2}), 0);
+    EXPECT_TRUE((box.center() == Point<2> {5, 2.5}));
+    EXPECT_TRUE((box.extent() == Point<2> {10, 5}));
+
+    // The empty box grows to the box of the points
+    AABB<2> points;
+    EXPECT_TRUE(points.isEmpty());
+    EXPECT_FALSE(points.intersects(box));
+    points.expand(Point<2> {3, 4}).expand(Point<2> {-1, 6});
+    EXPECT_TRUE((points == AABB<2>({-1, 4}, {3, 6})));
+    EXPECT_TRUE((merge(box, points) == AABB<2>({-1, 0}, {10, 6})));
+    EXPECT_TRUE((intersection(box, points) == AABB<2>({0, 4}, {3, 5})));
+    EXPECT_TRUE(intersection(box, AABB<2>({20, 20}, {30, 30})).isEmpty());
+    EXPECT_TRUE((points.expand(1) == AABB<2>({-2, 3}, {4, 7})));
+
+    AABB<2, int> cells;
+    cells.expand(Point<2, int> {2, 3});
+    EXPECT_TRUE((cells == AABB<2, int>({2, 3}, {2, 3})));
+
+    // Ray along the diagonal, and parallel to the x axis
+    double t_min = 0, t_max = 100;
+    EXPECT_TRUE(box.intersects_ray({-2, -2}, {1, 1}, t_min, t_max));
+    EXPECT_DOUBLE_EQ(t_min, 2);
+    EXPECT_DOUBLE_EQ(t_max, 7);
+    const double infinity = std::numeric_limits<double>::infinity();
+    t_min = 0;
+    t_max = 100;
+    EXPECT_TRUE(box.intersects_ray({-4, 1}, {1, infinity}, t_min, t_max));
+    EXPECT_DOUBLE_EQ(t_min, 4);
+    EXPECT_DOUBLE_EQ(t_max, 14);
+    t_min = 0;
+    t_max = 100;
+    EXPECT_FALSE(box.intersects_ray({-4, 6}, {1, infinity}, t_min, t_max));
+    t_min = 0;
+    t_max = 3;
+    EXPECT_FALSE(box.intersects_ray({-4, 1}, {1, infinity}, t_min, t_max));
+}
 }
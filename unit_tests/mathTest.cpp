@@ -9,6 +9,12 @@ TEST_F(mathTest, Max)
     EXPECT_EQ(max(1, 2, 3, 4, 5), 5);
 }
 
+TEST_F(mathTest, Min)
+{
+    EXPECT_EQ(min(3, 2, 5, 1, 4), 1);
+    EXPECT_EQ(min(1.5, -2.), -2.);
+}
+
 TEST_F(mathTest, Modulo)
 {
     EXPECT_TRUE(abs(modulo(1.2, 0.5) - 0.2) < 0.0001);
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <point_cloud.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace epstl
+{
+
+/*
+ * Fill the cloud with random points and return them. 1000 is not a multiple
+ * of the block size, so the kernels also run their scalar tail.
+ */
+static std::vector<Point<3, float>> fill_random(point_cloud<3, float>& cloud,
+                                 size_t count = 1000)
+{
+    std::vector<Point<3, float>> points;
+    for (size_t i = 0; i < count; i++)
+    {
+        Point<3, float> point = {std::rand() % 200 - 100.f,
+                                 std::rand() % 200 - 100.f,
+                                 std::rand() % 200 - 100.f
+                                };
+        points.push_back(point);
+        cloud.push_back(point);
+    }
+    return points;
+}
+
+TEST(pointCloudTest, Storage)
+{
+    point_cloud<3, float> cloud;
+    EXPECT_EQ(cloud.push_back({1, 2, 3}), 1u);
+    EXPECT_EQ(cloud.push_back({4, 5, 6}), 2u);
+    EXPECT_TRUE((cloud[1] == Point<3, float> {4, 5, 6}));
+    EXPECT_EQ(cloud.coordinates(2)[0], 3);
+
+    cloud.set(0, {7, 8, 9});
+    EXPECT_TRUE((cloud[0] == Point<3, float> {7, 8, 9}));
+    EXPECT_EQ(cloud.pop_back(), 1u);
+
+    // Growing keeps the points and the alignment of each axis
+    std::vector<Point<3, float>> points = fill_random(cloud);
+    EXPECT_EQ(cloud.size(), points.size() + 1);
+    EXPECT_GE(cloud.capacity(), cloud.size());
+    for (size_t axis = 0; axis < 3; axis++)
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(cloud.coordinates(axis)) % 64, 0u);
+    EXPECT_TRUE((cloud[0] == Point<3, float> {7, 8, 9}));
+    for (size_t i = 0; i < points.size(); i++)
+        ASSERT_TRUE(cloud[i + 1] == points[i]);
+}
+
+TEST(pointCloudTest, Distances)
+{
+    point_cloud<3, float> cloud;
+    std::vector<Point<3, float>> points = fill_random(cloud);
+    size_t count = points.size();
+
+    Point<3, float> origin = {10, -20, 5};
+    std::vector<float> distances(count);
+    cloud.distances(origin, distances.data());
+    std::vector<float> squared(count);
+    cloud.squared_distances(origin, squared.data());
+    for (size_t i = 0; i < count; i++)
+    {
+        ASSERT_FLOAT_EQ(distances[i], distance(points[i], origin));
+        ASSERT_FLOAT_EQ(squared[i], squared_distance(points[i], origin));
+    }
+
+    std::unique_ptr<bool[]> inside(new bool[count]);
+    size_t expected_count = 0;
+    for (const auto& point : points)
+        expected_count += squared_distance(point, origin) <= 50 * 50;
+    EXPECT_EQ(cloud.within_radius(origin, 50, inside.get()), expected_count);
+    for (size_t i = 0; i < count; i++)
+        ASSERT_EQ(inside[i], squared_distance(points[i], origin) <= 50 * 50);
+}
+
+TEST(pointCloudTest, BoundsAndCentroid)
+{
+    point_cloud<3, float> cloud;
+    std::vector<Point<3, float>> points = fill_random(cloud);
+
+    Point<3, float> low, high, sum;
+    for (const auto& point : points)
+        sum += point;
+    ASSERT_TRUE(cloud.bounding_box(low, high));
+    Point<3, float> centroid = cloud.centroid();
+    for (size_t axis = 0; axis < 3; axis++)
+    {
+        auto compare = [axis](const Point<3, float>& a, const Point<3, float>& b)
+        {
+            return a[axis] < b[axis];
+        };
+        EXPECT_EQ(low[axis],
+                  (*std::min_element(points.begin(), points.end(), compare))[axis]);
+        EXPECT_EQ(high[axis],
+                  (*std::max_element(points.begin(), points.end(), compare))[axis]);
+        EXPECT_FLOAT_EQ(centroid[axis], sum[axis] / points.size());
+    }
+}
+
+TEST(pointCloudTest, Transform)
+{
+    point_cloud<3, float> cloud;
+    std::vector<Point<3, float>> points = fill_random(cloud);
+
+    // Rotation of a quarter turn around z, then a translation
+    const point_cloud<3, float>::matrix_t matrix =
+    {
+        {0, -1, 0, 1},
+        {1, 0, 0, 2},
+        {0, 0, 1, 3}
+    };
+    cloud.transform(matrix);
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        Point<3, float> expected = {1 - points[i].y(), 2 + points[i].x(),
+                                    3 + points[i].z()
+                                   };
+        ASSERT_TRUE(cloud[i] == expected);
+    }
+}
+
+TEST(pointCloudTest, Empty)
+{
+    point_cloud<3, float> empty;
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.pop_back(), 0u);
+    Point<3, float> low, high;
+    EXPECT_FALSE(empty.bounding_box(low, high));
+    EXPECT_TRUE((empty.centroid() == Point<3, float>()));
+    EXPECT_EQ(empty.within_radius({0, 0, 0}, 10, nullptr), 0u);
+    empty.squared_distances({0, 0, 0}, nullptr);
+
+    // Copies of an empty cloud, which has no storage
+    point_cloud<3, float> copy(empty);
+    EXPECT_EQ(copy.size(), 0u);
+    point_cloud<3, float> filled;
+    filled.push_back({1, 2, 3});
+    filled = empty;
+    EXPECT_EQ(filled.size(), 0u);
+    filled.push_back({4, 5, 6});
+    EXPECT_TRUE((filled[0] == Point<3, float> {4, 5, 6}));
+
+    empty.reserve(10);
+    EXPECT_GE(empty.capacity(), 10u);
+    EXPECT_EQ(empty.size(), 0u);
+}
+
+TEST(pointCloudTest, CopyMove)
+{
+    point_cloud<3, float> cloud;
+    std::vector<Point<3, float>> points = fill_random(cloud);
+
+    point_cloud<3, float> copy(cloud);
+    copy.set(0, {0, 0, 0});
+    EXPECT_TRUE(cloud[0] == points[0]);
+    ASSERT_EQ(copy.size(), points.size());
+    for (size_t i = 1; i < points.size(); i++)
+        ASSERT_TRUE(copy[i] == points[i]);
+
+    point_cloud<3, float> assigned;
+    assigned.push_back({1, 2, 3});
+    assigned = cloud;
+    ASSERT_EQ(assigned.size(), points.size());
+    EXPECT_TRUE(assigned[points.size() - 1] == points.back());
+    assigned = assigned;
+    EXPECT_EQ(assigned.size(), points.size());
+
+    point_cloud<3, float> moved(std::move(copy));
+    EXPECT_EQ(moved.size(), points.size());
+    EXPECT_EQ(copy.size(), 0u);
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.size(), points.size());
+    EXPECT_EQ(moved.size(), 0u);
+    EXPECT_TRUE((assigned[0] == Point<3, float> {0, 0, 0}));
+}
+
+} // namespace epstl
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <polygon.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace epstl
+{
+
+TEST(polygonTest, Measures)
+{
+    Polygon<double> triangle = {{0, 0}, {4, 0}, {0, 4}};
+    EXPECT_EQ(triangle.size(), 3u);
+    EXPECT_DOUBLE_EQ(triangle.signed_area(), 8);
+    EXPECT_DOUBLE_EQ(triangle.area(), 8);
+    EXPECT_TRUE(triangle.isCounterClockwise());
+    EXPECT_TRUE((triangle.centroid() == Point<2> {4. / 3, 4. / 3}));
+    EXPECT_TRUE((triangle.bounding_box() == AABB<2>({0, 0}, {4, 4})));
+    EXPECT_TRUE((triangle.edge(2).start == Point<2> {0, 4}));
+    EXPECT_TRUE((triangle.edge(2).end == Point<2> {0, 0}));
+
+    triangle.reverse();
+    EXPECT_DOUBLE_EQ(triangle.signed_area(), -8);
+    EXPECT_FALSE(triangle.isCounterClockwise());
+    EXPECT_TRUE((triangle.centroid() == Point<2> {4. / 3, 4. / 3}));
+
+    // Without area, the centroid is the mean of the vertices
+    const int line[] = {0, 0, 2, 2, 4, 4};
+    Polygon<int> flat(line, 3);
+    EXPECT_DOUBLE_EQ(flat.area(), 0);
+    EXPECT_TRUE((flat.centroid() == Point<2, int> {2, 2}));
+}
+
+TEST(polygonTest, Containment)
+{
+    // Left and bottom edges are inside, right and top edges are outside
+    Polygon<int> square = {{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+    for (int slabs = 0; slabs < 2; slabs++)
+    {
+        if (slabs)
+            square.build_slabs();
+        EXPECT_EQ(square.hasSlabs(), slabs == 1);
+        EXPECT_TRUE(square.contains({0, 2}));
+        EXPECT_TRUE(square.contains({2, 0}));
+        EXPECT_FALSE(square.contains({4, 2}));
+        EXPECT_FALSE(square.contains({2, 4}));
+        EXPECT_TRUE(square.contains(3.5, 3.5));
+        EXPECT_FALSE(square.contains(-0.5, 2));
+    }
+
+    // Star with crossing edges, the center is inside for non-zero only
+    Polygon<double> pentagram = {{0, 3}, {1.76, -2.43}, {-2.85, 0.93},
+        {2.85, 0.93}, {-1.76, -2.43}
+    };
+    // Star shaped polygon with many vertices and random radii
+    std::vector<Point<2>> vertices;
+    const int count = 500;
+    for (int i = 0; i < count; i++)
+    {
+        double angle = 6.283185307 * i / count;
+        double radius = 50 + std::rand() % 50;
+        vertices.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+    vector<Point<2>> star_vertices;
+    for (const auto& vertex : vertices)
+        star_vertices.push_back(vertex);
+    Polygon<double> star(star_vertices);
+
+    for (Polygon<double>* polygon : {&pentagram, &star})
+    {
+        std::vector<double> xs, ys;
+        double extent = polygon == &star ? 100 : 3;
+        for (double y = -extent; y < extent; y += extent / 40)
+        {
+            for (double x = -extent; x < extent; x += extent / 40)
+            {
+                xs.push_back(x);
+                ys.push_back(y);
+            }
+        }
+        std::vector<double> flat;
+        for (size_t i = 0; i < polygon->size(); i++)
+        {
+            flat.push_back((*polygon)[i].x());
+            flat.push_back((*polygon)[i].y());
+        }
+
+        for (fill_rule_t rule : {fill_even_odd, fill_non_zero})
+        {
+            std::unique_ptr<bool[]> expected(new bool[xs.size()]);
+            std::unique_ptr<bool[]> inside(new bool[xs.size()]);
+            size_t expected_count = points_in_polygon(flat.data(),
+                                    polygon->size(), xs.data(), ys.data(),
+                                    xs.size(), expected.get(), rule);
+            Polygon<double> slabs = *polygon;
+            slabs.build_slabs();
+            ASSERT_EQ(polygon->contains(xs.data(), ys.data(), xs.size(),
+                                        inside.get(), rule), expected_count);
+            for (size_t i = 0; i < xs.size(); i++)
+                ASSERT_EQ(inside[i], expected[i]);
+            ASSERT_EQ(slabs.contains(xs.data(), ys.data(), xs.size(),
+                                     inside.get(), rule), expected_count);
+            for (size_t i = 0; i < xs.size(); i++)
+            {
+                ASSERT_EQ(inside[i], expected[i]);
+                ASSERT_EQ(polygon->contains({xs[i], ys[i]}, rule), expected[i]);
+            }
+        }
+    }
+    EXPECT_FALSE(pentagram.contains({0, 0}));
+    EXPECT_TRUE(pentagram.contains({0, 0}, fill_non_zero));
+}
+
+} // namespace epstl
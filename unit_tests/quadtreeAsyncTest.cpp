@@ -0,0 +1,107 @@
+#include <quadtree_async.hpp>
+#include <algorithm>
+#include <vector>
+#include "quadtreeAsyncTest.hpp"
+
+namespace epstl
+{
+
+namespace
+{
+std::vector<std::pair<int, int>> sorted_keys(const vector<epstl::pair<int>>&
+        keys)
+{
+    std::vector<std::pair<int, int>> sorted;
+    for (size_t i = 0; i < keys.size(); i++)
+        sorted.push_back({keys[i].first, keys[i].second});
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+}
+
+/*
+ * Test the synchronous range and nearest queries
+ */
+TEST_F(quadtreeAsyncTest, SyncQueries)
+{
+    quadtree<int, int> tree(20, 20);
+    tree.insert(5, 5, 100);
+    tree.insert(-5, 5, 20);
+    tree.insert(2, 3, 300);
+    tree.insert(8, 3, 310);
+    tree.insert(1, 2, 400);
+
+    vector<epstl::pair<int>> keys;
+    EXPECT_EQ(tree.query_range(0, 0, 5, 5, keys), 3);
+    std::vector<std::pair<int, int>> expected{{1, 2}, {2, 3}, {5, 5}};
+    EXPECT_EQ(sorted_keys(keys), expected);
+
+    vector<epstl::pair<int>> neighbours;
+    ASSERT_EQ(tree.nearest(7, 4, 2, neighbours), 2);
+    EXPECT_EQ(neighbours[0].first, 8);
+    EXPECT_EQ(neighbours[0].second, 3);
+    EXPECT_EQ(neighbours[1].first, 5);
+    EXPECT_EQ(neighbours[1].second, 5);
+}
+
+/*
+ * Test the asynchronous queries and the completion queue
+ */
+TEST_F(quadtreeAsyncTest, AsyncQueries)
+{
+    quadtree<int, int> tree(20, 20);
+    tree.insert(5, 5, 100);
+    tree.insert(-5, 5, 20);
+    tree.insert(2, 3, 300);
+
+    quadtree_async<int, int> async_tree(tree, 2, 4, true);
+    auto range = async_tree.query_range(-10, 0, 0, 10);
+    auto nearest = async_tree.nearest(3, 3, 1);
+    auto value = async_tree.at(5, 5);
+
+    std::vector<std::pair<int, int>> expected{{-5, 5}};
+    EXPECT_EQ(sorted_keys(range.get()), expected);
+    auto neighbours = nearest.get();
+    ASSERT_EQ(neighbours.size(), 1);
+    EXPECT_EQ(neighbours[0].first, 2);
+    EXPECT_EQ(value.get(), 100);
+
+    // Completion not tracked: the results are only given by the futures
+    quadtree_async<int, int> untracked(tree, 1);
+    EXPECT_EQ(untracked.at(5, 5).get(), 100);
+    vector<uint64_t> ignored;
+    EXPECT_EQ(untracked.poll(ignored), 0);
+
+    async_tree.modify([](quadtree<int, int>& modified_tree)
+    {
+        modified_tree.insert(-3, 3, 10);
+    });
+    EXPECT_EQ(async_tree.at(-3, 3).get(), 10);
+
+    vector<uint64_t> completed;
+    size_t count = 0;
+    while (count < 4)
+        count += async_tree.poll(completed);
+    EXPECT_EQ(completed.size(), 4);
+}
+
+/*
+ * Test the cancellation of a query
+ */
+TEST_F(quadtreeAsyncTest, Cancel)
+{
+    quadtree<int, int> tree(20, 20);
+    tree.insert(5, 5, 100);
+
+    quadtree_async<int, int> async_tree(tree, 1);
+    async_result<quadtree_async<int, int>::keys_t> range;
+    // The workers wait while the tree is modified
+    async_tree.modify([&](quadtree<int, int>&)
+    {
+        range = async_tree.query_range(-10, -10, 10, 10);
+        range.cancel();
+    });
+    EXPECT_THROW(range.get(), cancelled_exception);
+}
+
+} // namespace epstl
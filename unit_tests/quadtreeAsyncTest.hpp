@@ -0,0 +1,13 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+namespace epstl
+{
+
+class quadtreeAsyncTest : public ::testing::Test
+{
+  public:
+};
+
+} // namespace epstl
@@ -1,5 +1,6 @@
 #include "quadtreeRegionTest.hpp"
 #include <quadtree_region.hpp>
+#include <sstream>
 
 namespace epstl
 {
@@ -42,6 +43,660 @@ TEST_P(quadtreeRegionTest, UnsetPixel)
     EXPECT_EQ(tree->size(), expected_size);
 }
 
+TEST_P(quadtreeRegionTest, SetRegion)
+{
+    // Triangle going out of the tree
+    vector<int> triangle{x_min - 1, y_min, x_max, y_min + 1, x_min + 1, y_max + 1};
+    tree->set_region(triangle);
+    // Square in the middle
+    vector<int> square{x_min + 1, y_min + 1, x_max - 1, y_min + 1, x_max - 1, y_max - 1, x_min + 1, y_max - 1};
+    tree->unset_region(square);
+
+    size_t expected_size = 0;
+    for (int row = y_min ; row < y_max; row++)
+    {
+        SCOPED_TRACE(std::string("row : ") + std::to_string(row));
+        for (int col = x_min ; col < x_max; col++)
+        {
+            SCOPED_TRACE(std::string("col : ") + std::to_string(col));
+            bool expected = std::find(points.begin(), points.end(),
+                                      std::pair<int, int> {col, row}) != points.end();
+            if (tree_type::isInside(triangle, col + 0.5, row + 0.5))
+                expected = true;
+            if (tree_type::isInside(square, col + 0.5, row + 0.5))
+                expected = false;
+            EXPECT_EQ(tree->at(col, row), expected);
+            expected_size += expected;
+        }
+    }
+    EXPECT_EQ(tree->size(), expected_size);
+
+    vector<int> all{x_min, y_min, x_max, y_min, x_max, y_max, x_min, y_max};
+    tree->unset_region(all);
+    EXPECT_EQ(tree->size(), 0);
+    EXPECT_EQ(tree->depth(), 0);
+    tree->set_region(all);
+    EXPECT_EQ(tree->size(), (x_max - x_min) * (y_max - y_min));
+    EXPECT_EQ(tree->depth(), 0);
+}
+
+TEST_P(quadtreeRegionTest, SetRect)
+{
+    tree->set_rect(x_min + 1, y_min - 2, x_max - 1, y_min + 2);
+    tree->unset_rect(x_min, y_min + 1, x_min + 3, y_max + 5);
+    // Empty rectangle
+    tree->set_rect(x_max - 1, y_min, x_max - 1, y_max);
+
+    size_t expected_size = 0;
+    for (int row = y_min ; row < y_max; row++)
+    {
+        for (int col = x_min ; col < x_max; col++)
+        {
+            bool expected = std::find(points.begin(), points.end(),
+                                      std::pair<int, int> {col, row}) != points.end();
+            if (col >= x_min + 1 && col < x_max - 1 && row < y_min + 2)
+                expected = true;
+            if (col < x_min + 3 && row >= y_min + 1)
+                expected = false;
+            EXPECT_EQ(tree->at(col, row), expected) << col << ", " << row;
+            expected_size += expected;
+        }
+    }
+    EXPECT_EQ(tree->size(), expected_size);
+
+    tree->set_rect(x_min - 10, y_min - 10, x_max + 10, y_max + 10);
+    EXPECT_EQ(tree->size(), (x_max - x_min) * (y_max - y_min));
+    EXPECT_EQ(tree->depth(), 0);
+    tree->unset_rect(x_min, y_min, x_max, y_max);
+    EXPECT_EQ(tree->size(), 0);
+    EXPECT_EQ(tree->depth(), 0);
+}
+
+TEST_P(quadtreeRegionTest, CountSet)
+{
+    tree->set_rect(x_min + 1, y_min + 1, x_max - 1, y_min + 3);
+    for (int left = x_min - 1; left < x_max; left += 2)
+    {
+        for (int bottom = y_min - 1; bottom < y_max; bottom += 3)
+        {
+            int right = left + 4;
+            int top = bottom + 3;
+            size_t expected = 0;
+            for (int row = bottom; row < top; row++)
+            {
+                for (int col = left; col < right; col++)
+                    expected += tree->at(col, row);
+            }
+            EXPECT_EQ(tree->count_set(left, bottom, right, top), expected)
+                    << left << ", " << bottom;
+            EXPECT_DOUBLE_EQ(tree->coverage(left, bottom, right, top), expected / 12.);
+        }
+    }
+    EXPECT_EQ(tree->count_set(x_min, y_min, x_max, y_max), tree->size());
+    EXPECT_EQ(tree->count_set(x_min, y_min, x_min, y_max), 0);
+    EXPECT_EQ(tree->coverage(x_min, y_min, x_min, y_max), 0);
+}
+
+TEST_P(quadtreeRegionTest, Bitmap)
+{
+    tree->set_rect(x_min + 1, y_min + 1, x_max - 1, y_min + 3);
+    size_t stride = tree->bitmap_stride();
+    std::vector<uint64_t> bitmap(stride * GetParam().second);
+    tree->to_bitmap(bitmap.data());
+    for (int row = y_min ; row < y_max; row++)
+    {
+        for (int col = x_min ; col < x_max; col++)
+        {
+            size_t bit = col - x_min;
+            bool state = (bitmap[(row - y_min) * stride + bit / 64] >> (bit % 64)) & 1;
+            EXPECT_EQ(state, tree->at(col, row)) << col << ", " << row;
+        }
+    }
+
+    tree_type imported(GetParam().first, GetParam().second);
+    imported.set(x_min, y_min);
+    EXPECT_EQ(imported.from_bitmap(bitmap.data()), tree->size());
+    EXPECT_EQ(imported.depth(), tree->depth());
+    for (int row = y_min ; row < y_max; row++)
+    {
+        for (int col = x_min ; col < x_max; col++)
+            EXPECT_EQ(imported.at(col, row), tree->at(col, row)) << col << ", " << row;
+    }
+
+    std::stringstream printed;
+    std::stringstream expected;
+    tree->print(printed);
+    expected << "Tree:\n";
+    for (int row = y_max - 1 ; row >= y_min; row--)
+    {
+        for (int col = x_min ; col < x_max; col++)
+            expected << (tree->at(col, row) ? '1' : '0') << " ";
+        expected << "\n";
+    }
+    EXPECT_EQ(printed.str(), expected.str());
+}
+
+/*
+ * Bitmaps wider than a word
+ */
+TEST(quadtreeRegionBitmapTest, Wide)
+{
+    quadtree_region<int> tree(0, 0, 300, 70);
+    tree.set_rect(-140, -30, 130, 20);
+    tree.unset_rect(-3, -2, 60, 1);
+    tree.set(-150, -35);
+    size_t stride = tree.bitmap_stride();
+    EXPECT_EQ(stride, 5);
+    std::vector<uint64_t> bitmap(stride * 70);
+    tree.to_bitmap(bitmap.data());
+
+    quadtree_region<int> imported(0, 0, 300, 70);
+    EXPECT_EQ(imported.from_bitmap(bitmap.data()), tree.size());
+    EXPECT_EQ(imported.depth(), tree.depth());
+    EXPECT_EQ(imported.count_set(-150, -35, 150, 35), tree.size());
+    for (int row = -35 ; row < 35; row++)
+    {
+        for (int col = -150 ; col < 150; col++)
+            EXPECT_EQ(imported.at(col, row), tree.at(col, row)) << col << ", " << row;
+    }
+}
+
+TEST_P(quadtreeRegionTest, DilateErode)
+{
+    tree->set_rect(x_min + 2, y_min + 1, x_min + 4, y_max);
+    for (int radius = 0; radius <= 3; radius++)
+    {
+        SCOPED_TRACE(std::string("radius : ") + std::to_string(radius));
+        tree_type dilated(*tree);
+        tree_type eroded(*tree);
+        dilated.dilate(radius);
+        eroded.erode(radius);
+        size_t dilated_size = 0;
+        size_t eroded_size = 0;
+        for (int row = y_min ; row < y_max; row++)
+        {
+            for (int col = x_min ; col < x_max; col++)
+            {
+                bool any = false;
+                bool all = true;
+                for (int y = y_min ; y < y_max; y++)
+                {
+                    for (int x = x_min ; x < x_max; x++)
+                    {
+                        if ((x - col) * (x - col) + (y - row) * (y - row) > radius * radius)
+                            continue;
+                        any |= tree->at(x, y);
+                        all &= tree->at(x, y);
+                    }
+                }
+                EXPECT_EQ(dilated.at(col, row), any) << col << ", " << row;
+                EXPECT_EQ(eroded.at(col, row), all) << col << ", " << row;
+                dilated_size += any;
+                eroded_size += all;
+            }
+        }
+        EXPECT_EQ(dilated.size(), dilated_size);
+        EXPECT_EQ(eroded.size(), eroded_size);
+    }
+}
+
+TEST_P(quadtreeRegionTest, ConnectedComponents)
+{
+    tree->set_rect(x_min + 1, y_min + 1, x_max - 1, y_min + 3);
+    int width = x_max - x_min;
+    int height = y_max - y_min;
+    for (bool item : {true, false})
+    {
+        for (bool eight_connected : {false, true})
+        {
+            SCOPED_TRACE(std::string("item : ") + std::to_string(item) +
+                         ", eight connected : " + std::to_string(eight_connected));
+            // Flood fill of the cells
+            std::vector<int> labels(width * height, -1);
+            std::vector<std::vector<int>> expected;
+            for (int start = 0; start < width * height; start++)
+            {
+                if (labels[start] >= 0 ||
+                        tree->at(start % width + x_min, start / width + y_min) != item)
+                    continue;
+                std::vector<int> component{0, x_max, y_max, x_min, y_min};
+                std::vector<int> stack{start};
+                labels[start] = expected.size();
+                while (!stack.empty())
+                {
+                    int cell = stack.back();
+                    stack.pop_back();
+                    int col = cell % width + x_min;
+                    int row = cell / width + y_min;
+                    component[0]++;
+                    component[1] = std::min(component[1], col);
+                    component[2] = std::min(component[2], row);
+                    component[3] = std::max(component[3], col + 1);
+                    component[4] = std::max(component[4], row + 1);
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        for (int dy = -1; dy <= 1; dy++)
+                        {
+                            if ((dx && dy && !eight_connected) || col + dx < x_min || col + dx >= x_max ||
+                                    row + dy < y_min || row + dy >= y_max)
+                                continue;
+                            int next = (row + dy - y_min) * width + col + dx - x_min;
+                            if (labels[next] < 0 && tree->at(col + dx, row + dy) == item)
+                            {
+                                labels[next] = expected.size();
+                                stack.push_back(next);
+                            }
+                        }
+                    }
+                }
+                expected.push_back(component);
+            }
+
+            vector<tree_type::component_t> components;
+            EXPECT_EQ(tree->connected_components(components, item, eight_connected),
+                      expected.size());
+            std::vector<std::vector<int>> found;
+            for (size_t i = 0; i < components.size(); i++)
+                found.push_back({(int)components[i].area, components[i].left, components[i].bottom,
+                                 components[i].right, components[i].top});
+            std::sort(expected.begin(), expected.end());
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(found, expected);
+        }
+    }
+}
+
+TEST_P(quadtreeRegionTest, FindPath)
+{
+    int width = x_max - x_min;
+    int height = y_max - y_min;
+    // Free cells closest to two opposite corners
+    int start = 0;
+    while (start < width * height &&
+            tree->at(start % width + x_min, start / width + y_min))
+        start++;
+    int goal = width * height - 1;
+    while (goal >= 0 && tree->at(goal % width + x_min, goal / width + y_min))
+        goal--;
+    int start_x = start % width + x_min, start_y = start / width + y_min;
+    int goal_x = goal % width + x_min, goal_y = goal / width + y_min;
+
+    // Breadth first search on the cells
+    std::vector<bool> reached(width * height, false);
+    std::vector<int> queue{start};
+    reached[start] = true;
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        int col = queue[i] % width + x_min;
+        int row = queue[i] / width + y_min;
+        const int moves[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        for (const auto& move : moves)
+        {
+            int x = col + move[0], y = row + move[1];
+            if (x < x_min || x >= x_max || y < y_min || y >= y_max)
+                continue;
+            int next = (y - y_min) * width + x - x_min;
+            if (!reached[next] && !tree->at(x, y))
+            {
+                reached[next] = true;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    vector<epstl::pair<double>> path;
+    bool found = tree->find_path(start_x, start_y, goal_x, goal_y, path);
+    EXPECT_EQ(found, (bool)reached[goal]);
+    if (found)
+    {
+        ASSERT_GE(path.size(), 2);
+        EXPECT_EQ(path[0].first, start_x + 0.5);
+        EXPECT_EQ(path[0].second, start_y + 0.5);
+        EXPECT_EQ(path[path.size() - 1].first, goal_x + 0.5);
+        EXPECT_EQ(path[path.size() - 1].second, goal_y + 0.5);
+        // The segments only cross free cells
+        for (size_t i = 1; i < path.size(); i++)
+        {
+            for (int step = 0; step < 16; step++)
+            {
+                double t = (step + 0.5) / 16;
+                double x = path[i - 1].first + t * (path[i].first - path[i - 1].first);
+                double y = path[i - 1].second + t * (path[i].second - path[i - 1].second);
+                EXPECT_FALSE(tree->at((int)std::floor(x), (int)std::floor(y)));
+            }
+        }
+    }
+
+    // A blocked goal can not be reached
+    if (!points.empty())
+    {
+        EXPECT_FALSE(tree->find_path(start_x, start_y, points[0].first,
+                                     points[0].second, path));
+    }
+}
+
+TEST_P(quadtreeRegionTest, Raycast)
+{
+    // Entry distance of the ray in each set cell
+    auto first_hit = [&](double ox, double oy, double dx, double dy, double range)
+    {
+        double best = range;
+        for (const auto& pt : points)
+        {
+            double enter = 0, exit = range;
+            double low[2] = {(double)pt.first, (double)pt.second};
+            double origin[2] = {ox, oy};
+            double direction[2] = {dx, dy};
+            for (int axis = 0; axis < 2; axis++)
+            {
+                if (direction[axis] == 0)
+                {
+                    if (origin[axis] < low[axis] || origin[axis] >= low[axis] + 1)
+                        exit = -1;
+                    continue;
+                }
+                double t0 = (low[axis] - origin[axis]) / direction[axis];
+                double t1 = (low[axis] + 1 - origin[axis]) / direction[axis];
+                enter = std::max(enter, std::min(t0, t1));
+                exit = std::min(exit, std::max(t0, t1));
+            }
+            if (enter < exit)
+                best = std::min(best, enter);
+        }
+        return best;
+    };
+
+    int width = x_max - x_min;
+    int height = y_max - y_min;
+    for (int i = 0; i < 100; i++)
+    {
+        double ox = x_min + width * (std::rand() / (double)RAND_MAX);
+        double oy = y_min + height * (std::rand() / (double)RAND_MAX);
+        double angle = std::rand() / (double)RAND_MAX * 6.283185307;
+        double range = std::rand() % 20;
+        double expected = first_hit(ox, oy, std::cos(angle), std::sin(angle), range);
+        double distance;
+        EXPECT_EQ(tree->raycast(ox, oy, std::cos(angle), std::sin(angle), range,
+                                distance), expected < range);
+        EXPECT_NEAR(distance, expected, 1e-9);
+    }
+
+    // Axis aligned fan from a cell center
+    double distances[4];
+    size_t hits = tree->raycast_fan(x_min + 0.5, y_min + 0.5, 0, std::acos(-1) / 2,
+                                    4, 100, distances);
+    size_t expected_hits = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        double angle = i * std::acos(-1) / 2;
+        double dx = std::round(std::cos(angle)), dy = std::round(std::sin(angle));
+        double expected = first_hit(x_min + 0.5, y_min + 0.5, dx, dy, 100);
+        expected_hits += expected < 100;
+        EXPECT_NEAR(distances[i], expected, 1e-9);
+    }
+    EXPECT_EQ(hits, expected_hits);
+
+    for (int i = 0; i < 100; i++)
+    {
+        int from_x = std::rand() % width + x_min, from_y = std::rand() % height + y_min;
+        int to_x = std::rand() % width + x_min, to_y = std::rand() % height + y_min;
+        double dx = to_x - from_x, dy = to_y - from_y;
+        double length = std::hypot(dx, dy);
+        bool expected = length == 0 ? !tree->at(from_x, from_y) :
+                        first_hit(from_x + 0.5, from_y + 0.5, dx / length, dy / length,
+                                  length) == length;
+        EXPECT_EQ(tree->line_of_sight(from_x, from_y, to_x, to_y), expected);
+    }
+
+    double distance;
+    EXPECT_THROW(tree->raycast(0, 0, 0, 0, 10, distance), epstl::value_exception);
+}
+
+TEST_P(quadtreeRegionTest, Encoding)
+{
+    tree->set_rect(x_min + 1, y_min + 1, x_max - 1, y_min + 3);
+    std::stringstream stream;
+    size_t bytes = tree->encode(stream);
+    EXPECT_EQ(stream.str().size(), bytes);
+
+    tree_type decoded(GetParam().first, GetParam().second);
+    decoded.set(x_min, y_min);
+    EXPECT_EQ(decoded.decode(stream), tree->size());
+    EXPECT_EQ(decoded.depth(), tree->depth());
+    for (int row = y_min; row < y_max; row++)
+        for (int col = x_min; col < x_max; col++)
+            EXPECT_EQ(decoded.at(col, row), tree->at(col, row));
+
+    // A truncated encoding is rejected
+    std::string truncated = stream.str().substr(0, bytes / 2);
+    std::stringstream truncated_stream(truncated);
+    EXPECT_THROW(decoded.decode(truncated_stream), epstl::value_exception);
+    EXPECT_EQ(decoded.size(), 0);
+}
+
+TEST_P(quadtreeRegionTest, Contains)
+{
+    vector<int> triangle{x_min, y_min, x_max, y_min, x_min, y_max};
+    tree->set_region(triangle);
+    tree->unset(x_min, y_min);
+
+    // Some points are outside of the tree
+    const size_t count = 500;
+    int xs[count], ys[count];
+    bool inside[count];
+    size_t expected_count = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        xs[i] = std::rand() % (GetParam().first + 4) + x_min - 2;
+        ys[i] = std::rand() % (GetParam().second + 4) + y_min - 2;
+        expected_count += tree->at(xs[i], ys[i]);
+    }
+    EXPECT_EQ(tree->contains(xs, ys, count, inside), expected_count);
+    for (size_t i = 0; i < count; i++)
+        EXPECT_EQ(inside[i], tree->at(xs[i], ys[i]));
+
+    tree_type filled(0, 0, GetParam().first, GetParam().second, true);
+    EXPECT_EQ(filled.contains(xs, ys, count, inside), count);
+}
+
+TEST_P(quadtreeRegionTest, ChangeTracking)
+{
+    tree_type before(*tree);
+    size_t epoch = tree->checkpoint();
+    tree_type other(GetParam().first, GetParam().second);
+    other.set_rect(x_min, y_min, x_min + 3, y_min + 3);
+    *tree ^= other;
+    tree->set(x_max - 1, y_max - 1);
+
+    vector<tree_type::rect_t> changed;
+    tree->changes_since(epoch, changed);
+    vector<tree_type::rect_t> diff;
+    size_t different = tree->region_diff(before, diff);
+    size_t listed_cells = 0;
+    for (size_t i = 0; i < changed.size(); i++)
+        listed_cells += (changed[i].right - changed[i].left) *
+                        (changed[i].top - changed[i].bottom);
+    EXPECT_GE(listed_cells, different);
+    for (int row = y_min; row < y_max; row++)
+    {
+        for (int col = x_min; col < x_max; col++)
+        {
+            if (tree->at(col, row) == before.at(col, row))
+                continue;
+            bool listed = false;
+            for (size_t i = 0; i < changed.size(); i++)
+                listed |= col >= changed[i].left && col < changed[i].right &&
+                          row >= changed[i].bottom && row < changed[i].top;
+            EXPECT_TRUE(listed);
+        }
+    }
+}
+
+TEST_P(quadtreeRegionTest, NearestSet)
+{
+    tree->set_rect(x_min, y_min, x_min + 2, y_min + 2);
+    for (int row = y_min - 2; row < y_max + 2; row++)
+    {
+        for (int col = x_min - 2; col < x_max + 2; col++)
+        {
+            double expected = -1;
+            for (int y = y_min; y < y_max; y++)
+            {
+                for (int x = x_min; x < x_max; x++)
+                {
+                    double distance = std::hypot(x - col, y - row);
+                    if (tree->at(x, y) && (expected < 0 || distance < expected))
+                        expected = distance;
+                }
+            }
+            int nearest_x, nearest_y;
+            ASSERT_TRUE(tree->nearest_set(col, row, nearest_x, nearest_y));
+            EXPECT_TRUE(tree->at(nearest_x, nearest_y));
+            EXPECT_DOUBLE_EQ(std::hypot(nearest_x - col, nearest_y - row),
+                             expected);
+            // The bound is included: exact on the integer distances
+            double bound = expected == std::floor(expected) ? expected :
+                           expected + 1e-9;
+            EXPECT_TRUE(tree->nearest_set(col, row, nearest_x, nearest_y,
+                                          bound));
+            EXPECT_FALSE(tree->nearest_set(col, row, nearest_x, nearest_y,
+                                           expected - 0.5));
+        }
+    }
+
+    tree_type empty(GetParam().first, GetParam().second);
+    int nearest_x, nearest_y;
+    EXPECT_FALSE(empty.nearest_set(0, 0, nearest_x, nearest_y));
+}
+
+TEST_P(quadtreeRegionTest, LevelOfDetail)
+{
+    tree->set_rect(x_min + 1, y_min + 1, x_max - 1, y_min + 3);
+    tree->unset(x_min + 2, y_min + 2);
+    struct block_t
+    {
+        int left, bottom, right, top;
+    };
+    for (size_t level = 0; level < 4; level++)
+    {
+        SCOPED_TRACE(std::string("level : ") + std::to_string(level));
+        size_t side = 1 << level;
+        std::vector<double> fractions(side * side, -1);
+        EXPECT_EQ(tree->downsample(level, fractions.data()), side);
+
+        // Blocks of the level, divided like the quadrants
+        std::vector<block_t> blocks{{x_min, y_min, x_max, y_max}};
+        for (size_t i = 0; i < level; i++)
+        {
+            std::vector<block_t> divided(blocks.size() * 4);
+            size_t span = 1 << i;
+            for (size_t row = 0; row < span; row++)
+            {
+                for (size_t col = 0; col < span; col++)
+                {
+                    block_t block = blocks[row * span + col];
+                    int center_x = (block.left + block.right) / 2.;
+                    int center_y = (block.bottom + block.top) / 2.;
+                    if (i == 0)
+                        center_x = center_y = 0;
+                    size_t below = 2 * row * 2 * span + 2 * col;
+                    size_t above = below + 2 * span;
+                    divided[below] = {block.left, block.bottom, center_x, center_y};
+                    divided[below + 1] = {center_x, block.bottom, block.right,
+                                          center_y
+                                         };
+                    divided[above] = {block.left, center_y, center_x, block.top};
+                    divided[above + 1] = {center_x, center_y, block.right,
+                                          block.top
+                                         };
+                }
+            }
+            blocks = divided;
+        }
+
+        for (size_t i = 0; i < blocks.size(); i++)
+        {
+            const block_t& block = blocks[i];
+            // Blocks without cells take the value of the enclosing leaf
+            if (block.right <= block.left || block.top <= block.bottom)
+                continue;
+            int area = (block.right - block.left) * (block.top - block.bottom);
+            int count = 0;
+            for (int row = block.bottom; row < block.top; row++)
+                for (int col = block.left; col < block.right; col++)
+                    count += tree->at(col, row);
+            EXPECT_DOUBLE_EQ(fractions[i], (double)count / area);
+            EXPECT_DOUBLE_EQ(tree->at_level(block.left, block.bottom, level),
+                             (double)count / area);
+        }
+    }
+}
+
+TEST_P(quadtreeRegionTest, BooleanOperations)
+{
+    tree_type other(GetParam().first, GetParam().second);
+    vector<int> triangle{x_min, y_min, x_max, y_min, x_min, y_max};
+    other.set_region(triangle);
+    other.unset(x_min, y_min);
+    other.set(x_max - 1, y_max - 1);
+
+    auto check = [&](const tree_type & result, bool (*operation)(bool, bool))
+    {
+        size_t expected_size = 0;
+        for (int row = y_min ; row < y_max; row++)
+        {
+            for (int col = x_min ; col < x_max; col++)
+            {
+                bool expected = operation(tree->at(col, row), other.at(col, row));
+                EXPECT_EQ(result.at(col, row), expected) << col << ", " << row;
+                expected_size += expected;
+            }
+        }
+        EXPECT_EQ(result.size(), expected_size);
+    };
+
+    tree_type result(*tree);
+    result |= other;
+    check(result, [](bool a, bool b)
+    {
+        return a || b;
+    });
+    tree_type intersection(*tree);
+    intersection &= other;
+    check(intersection, [](bool a, bool b)
+    {
+        return a && b;
+    });
+    tree_type difference(*tree);
+    difference -= other;
+    check(difference, [](bool a, bool b)
+    {
+        return a && !b;
+    });
+    tree_type symmetric(*tree);
+    symmetric ^= other;
+    check(symmetric, [](bool a, bool b)
+    {
+        return a != b;
+    });
+
+    // The result is merged: the region and its complement cover everything
+    tree_type complement(GetParam().first, GetParam().second);
+    EXPECT_EQ(complement.xor_with(*tree), tree->size());
+    EXPECT_EQ(complement.xor_with(*tree), 0);
+    EXPECT_EQ(complement.depth(), 0);
+    vector<int> all{x_min, y_min, x_max, y_min, x_max, y_max, x_min, y_max};
+    complement.set_region(all);
+    complement.subtract(*tree);
+    EXPECT_EQ(complement.union_with(*tree), (x_max - x_min) * (y_max - y_min));
+    EXPECT_EQ(complement.depth(), 0);
+    EXPECT_EQ(complement.xor_with(complement), 0);
+    EXPECT_EQ(complement.depth(), 0);
+
+    tree_type shifted(1, 0, GetParam().first, GetParam().second);
+    EXPECT_THROW(shifted.union_with(*tree), epstl::value_exception);
+}
+
 #if __cplusplus >= 201702L
 static const std::vector<std::pair<int, int>> dimensionValues {{7, 7}, {8, 8}, {10, 4}, {12, 5}, {7, 11}};
 
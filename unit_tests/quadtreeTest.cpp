@@ -1,5 +1,7 @@
 #include <quadtree.hpp>
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 #include "quadtreeTest.hpp"
 
@@ -12,6 +14,8 @@ namespace epstl
 TEST_F(quadtreeTest, Insertion)
 {
     quadtree<float, int> tree(20, 20);
+    // Empty tree
+    EXPECT_EQ(tree.at(5, 5), 0);
     EXPECT_EQ(tree.insert(5, 5, 100), 1);
     EXPECT_EQ(tree.depth(), 0);
 
@@ -160,4 +164,253 @@ TEST_F(quadtreeTest, RemoveByItem)
     EXPECT_TRUE(tree.find(100));
 }
 
+/*
+ * Item with padding: no unique byte representation to hash
+ */
+struct padded_item_t
+{
+    int id = 0;
+    double value = 0;
+
+    bool operator==(const padded_item_t& other) const
+    {
+        return id == other.id && value == other.value;
+    }
+};
+
+std::ostream& operator<<(std::ostream& stream, const padded_item_t& item)
+{
+    return stream << item.id << " " << item.value;
+}
+
+/*
+ * Test the content hash: same content gives the same hash
+ */
+TEST_F(quadtreeTest, Hash)
+{
+    quadtree<int, int> tree(20, 20);
+    tree.set_behaviour_flag(epstl::quadtree_hash);
+    EXPECT_EQ(tree.hash(), 0);
+    tree.insert(5, 5, 100);
+    tree.insert(2, 3, 300);
+    tree.insert(-5, 5, 20);
+
+    quadtree<int, int> other(20, 20);
+    other.insert(-5, 5, 20);
+    other.insert(2, 3, 300);
+    other.insert(5, 5, 100);
+    // Hashing enabled after the insertions
+    other.set_behaviour_flag(epstl::quadtree_hash);
+    EXPECT_EQ(tree.hash(), other.hash());
+
+    other.insert(2, 3, 301);
+    EXPECT_NE(tree.hash(), other.hash());
+    other.insert(2, 3, 300);
+    EXPECT_EQ(tree.hash(), other.hash());
+
+    other.remove(-5, 5);
+    EXPECT_NE(tree.hash(), other.hash());
+    tree.remove(-5, 5);
+    EXPECT_EQ(tree.hash(), other.hash());
+
+    quadtree<int, padded_item_t> padded(20, 20);
+    EXPECT_THROW(padded.set_behaviour_flag(epstl::quadtree_hash),
+                 epstl::value_exception);
+    padded.set_behaviour_flag(epstl::quadtree_no_replace);
+}
+
+/*
+ * Test the diff between two trees
+ */
+TEST_F(quadtreeTest, Diff)
+{
+    quadtree<int, int> tree(20, 20);
+    tree.set_behaviour_flag(epstl::quadtree_hash);
+    tree.insert(5, 5, 100);
+    tree.insert(2, 3, 300);
+    tree.insert(8, 3, 310);
+    tree.insert(-5, 5, 20);
+
+    quadtree<int, int> replica(tree);
+    vector<epstl::pair<int>> keys;
+    EXPECT_EQ(tree.diff(replica, keys), 0);
+
+    replica.insert(8, 3, 311);
+    replica.insert(-5, -5, 10);
+    replica.remove(5, 5);
+    ASSERT_EQ(tree.diff(replica, keys), 3);
+
+    std::vector<std::pair<int, int>> differences;
+    for (size_t i = 0; i < keys.size(); i++)
+        differences.push_back({keys[i].first, keys[i].second});
+    std::sort(differences.begin(), differences.end());
+    std::vector<std::pair<int, int>> expected{{-5, -5}, {5, 5}, {8, 3}};
+    EXPECT_EQ(differences, expected);
+
+    // Without hashing, the result is the same
+    quadtree<int, int> plain(20, 20);
+    plain.insert(2, 3, 300);
+    vector<epstl::pair<int>> plain_keys;
+    EXPECT_EQ(tree.diff(plain, plain_keys), 3);
+}
+
+/*
+ * Expose the bounds of the quadtree to test the children selection
+ */
+template<typename key_t>
+struct quadtreeBound : public quadtree<key_t, int>
+{
+    typedef typename quadtree<key_t, int>::rect_bound_t rect_bound_t;
+
+    static rect_bound_t make(key_t left, key_t bottom, key_t right, key_t top)
+    {
+        rect_bound_t bound;
+        bound.left = left;
+        bound.right = right;
+        bound.bottom = bottom;
+        bound.top = top;
+        bound.center.x = (left + right) / 2.;
+        bound.center.y = (bottom + top) / 2.;
+        return bound;
+    }
+
+    /*
+     * Check childIndex and childrenMask against the bounds of each child
+     */
+    static void check(key_t left, key_t bottom, key_t right, key_t top)
+    {
+        rect_bound_t bound = make(left, bottom, right, top);
+        rect_bound_t children[4] =
+        {
+            make(left, bottom, bound.center.x, bound.center.y),
+            make(bound.center.x, bottom, right, bound.center.y),
+            make(left, bound.center.y, bound.center.x, top),
+            make(bound.center.x, bound.center.y, right, top)
+        };
+        for (key_t x = left - 1; x <= right; x++)
+        {
+            for (key_t y = bottom - 1; y <= top; y++)
+            {
+                uint8_t expected = 0;
+                for (uint8_t i = 0; i < 4; i++)
+                    expected |= children[i].isInside(x, y) << i;
+                EXPECT_EQ(bound.childrenMask(x, y, x, y), expected);
+                if (bound.isInside(x, y))
+                {
+                    EXPECT_EQ(1 << bound.childIndex(x, y), expected);
+                }
+            }
+        }
+        // Rectangle overlapping the west children only
+        EXPECT_EQ(bound.childrenMask(left - 5, bottom, left + 1, top),
+                  (1 << quadrant_sw) | (1 << quadrant_nw));
+        EXPECT_EQ(bound.childrenMask(right, top, right + 1, top + 1), 0);
+    }
+};
+
+/*
+ * Test the branchless children selection
+ */
+TEST_F(quadtreeTest, ChildrenSelection)
+{
+    quadtreeBound<float>::check(-10, -6, 10, 6);
+    quadtreeBound<int32_t>::check(-10, -6, 10, 6);
+    quadtreeBound<double>::check(-3, -4, 9, 2);
+    quadtreeBound<int64_t>::check(-3, -4, 9, 2);
+}
+
+/*
+ * Test the depth limit: the points beyond are kept in the overflow bucket
+ */
+TEST_F(quadtreeTest, DepthLimit)
+{
+    quadtree<float, int> tree(20, 20);
+    EXPECT_EQ(tree.max_depth(), 32);
+    tree.set_max_depth(3);
+    tree.set_behaviour_flag(epstl::quadtree_hash);
+    // Nearly coincident points
+    for (int i = 0; i < 50; i++)
+        EXPECT_EQ(tree.insert(1 + i * 1e-6f, 1, i + 1), i + 1);
+    EXPECT_EQ(tree.depth(), 3);
+    for (int i = 0; i < 50; i++)
+        EXPECT_EQ(tree.at(1 + i * 1e-6f, 1), i + 1);
+
+    epstl::pair<float> keys;
+    EXPECT_TRUE(tree.find(42, keys));
+    EXPECT_FLOAT_EQ(keys.first, 1 + 41 * 1e-6f);
+
+    vector<epstl::pair<float>> found;
+    EXPECT_EQ(tree.query_range(0, 0, 2, 2, found), 50);
+    EXPECT_EQ(tree.query_range(AABB<2, float>({1, 1}, {1.0001f, 1}), found),
+              50);
+    vector<epstl::pair<float>> nearest;
+    EXPECT_EQ(tree.nearest(1, 1, 3, nearest), 3);
+    EXPECT_FLOAT_EQ(nearest[2].first, 1 + 2 * 1e-6f);
+
+    // The hash does not depend on the bucket
+    quadtree<float, int> other(20, 20);
+    other.set_behaviour_flag(epstl::quadtree_hash);
+    for (int i = 49; i >= 0; i--)
+        other.insert(1 + i * 1e-6f, 1, i + 1);
+    EXPECT_EQ(tree.hash(), other.hash());
+
+    quadtree<float, int> copy(tree);
+    tree.remove(1, 1);
+    EXPECT_EQ(tree.size(), 49);
+    EXPECT_EQ(tree.at(1, 1), 0);
+    EXPECT_EQ(tree.at(1 + 49 * 1e-6f, 1), 50);
+    tree.remove_all(0, [](const int& i1, const int&)
+    {
+        return i1 % 2 == 0;
+    });
+    EXPECT_EQ(tree.size(), 24);
+    EXPECT_EQ(tree.at(1 + 2 * 1e-6f, 1), 3);
+    EXPECT_EQ(tree.at(1 + 3 * 1e-6f, 1), 0);
+    EXPECT_EQ(copy.size(), 50);
+    EXPECT_EQ(copy.at(1, 1), 1);
+
+    // Raising the limit divides the full leaves again
+    tree.set_max_depth(32);
+    tree.insert(1 + 100 * 1e-6f, 1, 200);
+    EXPECT_EQ(tree.size(), 25);
+    EXPECT_EQ(tree.at(1 + 2 * 1e-6f, 1), 3);
+    EXPECT_GT(tree.depth(), 3);
+
+    for (int i = 0; i < 50; i++)
+        tree.remove(1 + i * 1e-6f, 1);
+    tree.remove(1 + 100 * 1e-6f, 1);
+    EXPECT_EQ(tree.size(), 0);
+    EXPECT_EQ(tree.depth(), 0);
+}
+
+/*
+ * Test the minimum cell size
+ */
+TEST_F(quadtreeTest, MinCellSize)
+{
+    quadtree<int, int> tree(16, 16);
+    tree.set_min_cell_size(4);
+    tree.insert(1, 1, 10);
+    tree.insert(2, 2, 20);
+    tree.insert(3, 3, 30);
+    tree.insert(-5, -5, 40);
+    // Quadrants of 8 then 4
+    EXPECT_EQ(tree.depth(), 2);
+    EXPECT_EQ(tree.size(), 4);
+    EXPECT_EQ(tree.at(2, 2), 20);
+    EXPECT_EQ(tree.at(3, 3), 30);
+
+    tree.set_behaviour_flag(epstl::quadtree_no_replace);
+    tree.insert(2, 2, 21);
+    EXPECT_EQ(tree.at(2, 2), 20);
+    EXPECT_EQ(tree.size(), 4);
+
+    // Unit integer cells are not divided, even without limits
+    quadtree<int, int> unit(0, 0, 1, 1);
+    unit.insert(0, 0, 1);
+    unit.insert(0, 0, 2);
+    EXPECT_EQ(unit.depth(), 0);
+    EXPECT_EQ(unit.at(0, 0), 2);
+}
+
 } // namespace epstl
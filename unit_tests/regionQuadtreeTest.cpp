@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+
+#include <region_quadtree.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace epstl
+{
+
+TEST(regionQuadtreeTest, CostMap)
+{
+    const int width = 16;
+    const int height = 12;
+    region_quadtree<int, uint8_t> tree(width, height);
+    std::vector<uint8_t> expected(width * height, 0);
+    auto cell = [&](int x, int y) -> uint8_t&
+    {
+        return expected[(y + height / 2) * width + x + width / 2];
+    };
+
+    for (int i = 0; i < 40; i++)
+    {
+        uint8_t value = std::rand() % 4;
+        if (i % 3 == 0)
+        {
+            int x = std::rand() % width - width / 2;
+            int y = std::rand() % height - height / 2;
+            tree.insert(x, y, value);
+            cell(x, y) = value;
+            continue;
+        }
+        int left = std::rand() % width - width / 2;
+        int bottom = std::rand() % height - height / 2;
+        int right = left + std::rand() % 8;
+        int top = bottom + std::rand() % 8;
+        tree.insert_rect(left, bottom, right, top, value);
+        for (int y = bottom; y < std::min(top, height / 2); y++)
+            for (int x = left; x < std::min(right, width / 2); x++)
+                cell(x, y) = value;
+    }
+
+    size_t non_zero = 0;
+    for (int y = -height / 2; y < height / 2; y++)
+    {
+        for (int x = -width / 2; x < width / 2; x++)
+        {
+            EXPECT_EQ(tree.at(x, y), cell(x, y));
+            non_zero += cell(x, y) != 0;
+        }
+    }
+    EXPECT_EQ(tree.size(), non_zero);
+    EXPECT_EQ(tree.count_set(-width / 2, -height / 2, width / 2, height / 2),
+              non_zero);
+
+    // A uniform map is a single leaf
+    tree.insert_rect(-width / 2, -height / 2, width / 2, height / 2, 7);
+    EXPECT_EQ(tree.leaf_count(), 1);
+    EXPECT_EQ(tree.size(), width * height);
+}
+
+TEST(regionQuadtreeTest, Tolerance)
+{
+    const int width = 64;
+    auto height_at = [](int x, int y)
+    {
+        return 0.01f * x + 0.005f * y;
+    };
+
+    region_quadtree<int, float> exact(width, width);
+    region_quadtree<int, float> smooth(width, width);
+    smooth.set_tolerance(0.05);
+    for (int y = -width / 2; y < width / 2; y++)
+    {
+        for (int x = -width / 2; x < width / 2; x++)
+        {
+            exact.insert(x, y, height_at(x, y));
+            smooth.insert(x, y, height_at(x, y));
+        }
+    }
+    EXPECT_EQ(exact.leaf_count(), width * width);
+    EXPECT_LT(smooth.leaf_count() * 8, exact.leaf_count());
+
+    // A cell moves by the tolerance at most, whatever the levels merged
+    double max_error = 0;
+    for (int y = -width / 2; y < width / 2; y++)
+        for (int x = -width / 2; x < width / 2; x++)
+            max_error = std::max(max_error, std::abs((double)smooth.at(x, y) -
+                                 height_at(x, y)));
+    EXPECT_LE(max_error, 0.05 + 1e-6);
+
+    region_quadtree<int, float> copy(smooth);
+    EXPECT_EQ(copy.tolerance(), 0.05);
+    EXPECT_EQ(copy.leaf_count(), smooth.leaf_count());
+    EXPECT_THROW(smooth.set_tolerance(-1), value_exception);
+}
+
+TEST(regionQuadtreeTest, Encoding)
+{
+    region_quadtree<int, float> tree(20, 13);
+    tree.insert_rect(-10, -6, 3, 2, 1.5f);
+    tree.insert(4, 4, -2.25f);
+    tree.insert_region({-8, -5, 7, 0, 0, 6}, 0.75f);
+
+    std::stringstream stream;
+    tree.encode(stream);
+    region_quadtree<int, float> decoded(20, 13);
+    EXPECT_EQ(decoded.decode(stream), tree.size());
+    EXPECT_EQ(decoded.leaf_count(), tree.leaf_count());
+    for (int y = -7; y < 7; y++)
+        for (int x = -10; x < 10; x++)
+            EXPECT_EQ(decoded.at(x, y), tree.at(x, y));
+
+    // Untouched tree
+    region_quadtree<int, float> empty(0, 0, 20, 13, 3.f);
+    std::stringstream empty_stream;
+    EXPECT_EQ(empty.encode(empty_stream), sizeof(float) + 1);
+    EXPECT_EQ(decoded.decode(empty_stream), 20 * 13);
+    EXPECT_EQ(decoded.at(1, 1), 3.f);
+}
+
+TEST(regionQuadtreeTest, DecodeInvalid)
+{
+    region_quadtree<int, bool> tree(2, 2);
+    tree.insert(0, 0, true);
+
+    // Only division bits: the decoding has to stop at the unit cells
+    std::stringstream divisions(std::string(1 << 20, '\xff'));
+    EXPECT_THROW(tree.decode(divisions), value_exception);
+    EXPECT_EQ(tree.size(), 0u);
+
+    std::stringstream truncated;
+    EXPECT_THROW(tree.decode(truncated), value_exception);
+    EXPECT_EQ(tree.size(), 0u);
+}
+
+TEST(regionQuadtreeTest, ChangeTracking)
+{
+    typedef region_quadtree<int, uint8_t> tree_type;
+    tree_type tree(32, 32);
+    tree.insert_rect(-16, -16, 0, 0, 3);
+    tree_type before(tree);
+    size_t epoch = tree.checkpoint();
+    vector<tree_type::rect_t> changed;
+    EXPECT_EQ(tree.changes_since(epoch, changed), 0);
+
+    tree.insert(5, 5, 1);
+    tree.insert_rect(-4, -4, 4, 4, 2);
+    tree.insert(10, -10, 0);
+    EXPECT_GT(tree.changes_since(epoch, changed), 0);
+    auto listed = [&](int x, int y)
+    {
+        for (size_t i = 0; i < changed.size(); i++)
+        {
+            const tree_type::rect_t& rect = changed[i];
+            if (x >= rect.left && x < rect.right && y >= rect.bottom &&
+                    y < rect.top)
+                return true;
+        }
+        return false;
+    };
+    size_t different = 0;
+    for (int y = -16; y < 16; y++)
+    {
+        for (int x = -16; x < 16; x++)
+        {
+            if (tree.at(x, y) == before.at(x, y))
+                continue;
+            EXPECT_TRUE(listed(x, y));
+            different++;
+        }
+    }
+    // The untouched quadrants are not listed
+    EXPECT_FALSE(listed(12, 12));
+    EXPECT_FALSE(listed(-12, -12));
+
+    // The diff lists exactly the changed cells
+    vector<tree_type::rect_t> diff;
+    EXPECT_EQ(tree.region_diff(before, diff), different);
+    EXPECT_EQ(before.region_diff(tree, diff), different);
+    for (size_t i = 0; i < diff.size(); i++)
+        for (int y = diff[i].bottom; y < diff[i].top; y++)
+            for (int x = diff[i].left; x < diff[i].right; x++)
+                EXPECT_NE(tree.at(x, y), before.at(x, y));
+
+    // A decoded tree changes as a whole
+    std::stringstream stream;
+    before.encode(stream);
+    tree.decode(stream);
+    vector<tree_type::rect_t> replaced;
+    EXPECT_EQ(tree.changes_since(epoch, replaced), 1);
+    EXPECT_EQ(tree.changes_since(tree.checkpoint(), replaced), 0);
+    EXPECT_EQ(tree.region_diff(before, diff), 0);
+
+    tree_type other(16, 16);
+    EXPECT_THROW(tree.region_diff(other, diff), value_exception);
+}
+
+} // namespace epstl
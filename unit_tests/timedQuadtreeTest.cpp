@@ -0,0 +1,75 @@
+#include <timed_quadtree.hpp>
+#include "timedQuadtreeTest.hpp"
+
+namespace epstl
+{
+
+/*
+ * Test the insertion and the time window of at
+ */
+TEST_F(timedQuadtreeTest, TimeWindow)
+{
+    timed_quadtree<int, int> tree(0, 0, 20, 20, 10, 4);
+    EXPECT_EQ(tree.insert(5, 5, 100, 12), 1);
+    EXPECT_EQ(tree.insert(3, 3, 110, 25), 2);
+    EXPECT_EQ(tree.insert(5, 5, 120, 31), 3);
+
+    EXPECT_EQ(tree.at(5, 5), 120);
+    EXPECT_EQ(tree.at(3, 3), 110);
+    EXPECT_EQ(tree.at(5, 5, 0, 20), 100);
+    EXPECT_EQ(tree.at(5, 5, 13, 30), tree.default_value());
+    EXPECT_EQ(tree.at(3, 3, 26, 40), tree.default_value());
+
+    epstl::pair<int> keys;
+    EXPECT_TRUE(tree.find(110, keys, 20, 30));
+    EXPECT_EQ(keys.first, 3);
+    EXPECT_EQ(keys.second, 3);
+    EXPECT_FALSE(tree.find(100, keys, 20, 40));
+}
+
+/*
+ * Test the expiry of the items
+ */
+TEST_F(timedQuadtreeTest, Expire)
+{
+    timed_quadtree<int, int> tree(0, 0, 20, 20, 10, 4);
+    tree.insert(5, 5, 100, 2);
+    tree.insert(-5, 5, 101, 8);
+    tree.insert(3, 3, 110, 15);
+    tree.insert(-3, 3, 111, 18);
+    tree.insert(2, -3, 120, 25);
+    EXPECT_EQ(tree.size(), 5);
+
+    // Whole generation discarded and partial filtering
+    tree.expire(16);
+    EXPECT_EQ(tree.size(), 2);
+    EXPECT_EQ(tree.at(5, 5), tree.default_value());
+    EXPECT_EQ(tree.at(3, 3), tree.default_value());
+    EXPECT_EQ(tree.at(-3, 3), 111);
+    EXPECT_EQ(tree.at(2, -3), 120);
+
+    // Items older than the cutoff are ignored
+    EXPECT_EQ(tree.insert(1, 1, 130, 10), 2);
+}
+
+/*
+ * Test the ring: old generations are dropped when moving forward
+ */
+TEST_F(timedQuadtreeTest, Ring)
+{
+    timed_quadtree<int, int> tree(0, 0, 20, 20, 10, 2);
+    tree.insert(5, 5, 100, 5);
+    tree.insert(3, 3, 110, 15);
+    EXPECT_EQ(tree.size(), 2);
+
+    tree.insert(-3, 3, 120, 25);
+    EXPECT_EQ(tree.size(), 2);
+    EXPECT_EQ(tree.at(5, 5), tree.default_value());
+    EXPECT_EQ(tree.at(3, 3), 110);
+
+    // Too old for the ring
+    EXPECT_EQ(tree.insert(1, 1, 130, 3), 2);
+    EXPECT_EQ(tree.at(1, 1), tree.default_value());
+}
+
+} // namespace epstl
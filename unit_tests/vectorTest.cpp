@@ -117,6 +117,66 @@ TEST_F(vectorTest, sortDescending)
         EXPECT_EQ(*v.at(i), *expected.at(i));
     }
 }
+
+TEST_F(vectorTest, copy)
+{
+    vector<int, 5> v{1, 2, 3, 4, 5, 6};
+    vector<int, 5> copy(v);
+
+    EXPECT_EQ(copy.size(), 6);
+    EXPECT_EQ(copy.allocated(), 10);
+    *copy.at(0) = 10;
+    copy.push_back(7);
+    EXPECT_EQ(*v.at(0), 1);
+    EXPECT_EQ(v.size(), 6);
+
+    vector<int, 5> assigned{8};
+    assigned = v;
+    v.pop_back();
+    EXPECT_EQ(assigned.size(), 6);
+    EXPECT_EQ(*assigned.at(5), 6);
+
+    assigned = assigned;
+    EXPECT_EQ(assigned.size(), 6);
+    EXPECT_EQ(*assigned.at(5), 6);
+}
+
+TEST_F(vectorTest, copyEmpty)
+{
+    vector<int, 5> empty;
+    vector<int, 5> copy(empty);
+
+    EXPECT_EQ(copy.size(), 0);
+    EXPECT_EQ(copy.allocated(), 0);
+    copy.push_back(1);
+    EXPECT_EQ(*copy.at(0), 1);
+
+    copy = empty;
+    EXPECT_EQ(copy.size(), 0);
+    EXPECT_EQ(empty.size(), 0);
+}
+
+TEST_F(vectorTest, move)
+{
+    vector<int, 5> v{1, 2, 3};
+    vector<int, 5> moved(std::move(v));
+
+    EXPECT_EQ(moved.size(), 3);
+    EXPECT_EQ(*moved.at(2), 3);
+    EXPECT_EQ(v.size(), 0);
+    EXPECT_EQ(v.allocated(), 0);
+
+    vector<int, 5> assigned{4, 5};
+    assigned = std::move(moved);
+    EXPECT_EQ(assigned.size(), 3);
+    EXPECT_EQ(*assigned.at(0), 1);
+    EXPECT_EQ(moved.size(), 0);
+    EXPECT_EQ(moved.allocated(), 0);
+
+    // The source stays usable
+    moved.push_back(6);
+    EXPECT_EQ(*moved.at(0), 6);
+}
 #endif
 
 } // namespace epstl